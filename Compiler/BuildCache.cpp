@@ -0,0 +1,230 @@
+// License:
+// 
+// Scyndi
+// Build Cache
+// 
+// 
+// 
+// 	(c) Jeroen P. Broks, 2026
+// 
+// 		This program is free software: you can redistribute it and/or modify
+// 		it under the terms of the GNU General Public License as published by
+// 		the Free Software Foundation, either version 3 of the License, or
+// 		(at your option) any later version.
+// 
+// 		This program is distributed in the hope that it will be useful,
+// 		but WITHOUT ANY WARRANTY; without even the implied warranty of
+// 		MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// 		GNU General Public License for more details.
+// 		You should have received a copy of the GNU General Public License
+// 		along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// 
+// 	Please note that some references to data like pictures or audio, do not automatically
+// 	fall under this licenses. Mostly this is noted in the respective files.
+// 
+// Version: 26.10.19
+// End License
+
+#include <filesystem>
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+
+#ifdef _WIN32
+#include <process.h>
+#define ScyndiPID _getpid
+#else
+#include <unistd.h>
+#define ScyndiPID getpid
+#endif
+
+#include <SlyvString.hpp>
+#include <SlyvStream.hpp>
+#include <SlyvQCol.hpp>
+#include <SlyvMD5.hpp>
+
+#include <JCR6_Core.hpp>
+#include <Lunatic.hpp>
+
+#include "BuildCache.hpp"
+#include "ScyndiProject.hpp"
+#include "Translate.hpp"
+#include "../ScyndiVersion.hpp"
+
+using namespace Slyvina;
+using namespace Slyvina::Units;
+using namespace Slyvina::JCR6;
+namespace fs = std::filesystem;
+
+namespace Scyndi {
+
+	static bool Enabled{ false };
+	static std::string Directory{ "" };
+	static uintmax_t MaxSize{ 0 };
+	static uint64
+		Hits{ 0 },
+		Misses{ 0 },
+		Stored{ 0 },
+		Evicted{ 0 };
+
+	void InitBuildCache(GINIE PrjData) {
+		Directory = PrjData->Value("Cache", "Directory");
+		Enabled = Directory.size() > 0;
+		auto MB{ std::atoll(PrjData->Value("Cache", "MaxSize").c_str()) }; if (MB <= 0) MB = 512;
+		MaxSize = (uintmax_t)MB * 1024 * 1024;
+		Hits = 0; Misses = 0; Stored = 0; Evicted = 0;
+		if (Enabled) QCol->Doing("Build cache", Directory);
+	}
+
+	bool BuildCacheEnabled() { return Enabled; }
+
+	static std::string CacheFile(std::string Key) { return Directory + "/" + Key.substr(0, 2) + "/" + Key + ".STB"; }
+	static std::string RecordFile(std::string SourceKey) { return Directory + "/" + SourceKey.substr(0, 2) + "/" + SourceKey + ".Deps"; }
+
+	// Line endings and trailing white space never make a difference to the translation, and they do differ between checkouts
+	static std::string Normalize(std::string src) {
+		std::string ret{ "" }, line{ "" };
+		auto Flush{ [&]() {
+			while (line.size() && (line.back() == ' ' || line.back() == '\t')) line.pop_back();
+			ret += line + "\n";
+			line = "";
+		} };
+		for (auto ch : src) {
+			if (ch == '\r') continue;
+			if (ch == '\n') Flush(); else line += ch;
+		}
+		if (line.size()) Flush();
+		return ret;
+	}
+
+	std::string BuildCacheSourceKey(std::string ScyndiSource, std::string src, const BuildCacheFlags& Flags) {
+		if (!Enabled) return "";
+		std::string K{ "Scyndi " + QVersion.Version(true) + "\nLua " + NSLunatic::_Lunatic::LuaVersion() + "\n" };
+		K += "Debug=" + boolstring(Flags.Debug) + "\nRelease=" + boolstring(Flags.Release) + "\nLineCalls=" + boolstring(Flags.LineCalls) + "\nInline=" + std::to_string(Flags.Inline) + "\n";
+		K += "Deterministic=" + boolstring(TransDeterministic) + "\nStorage=" + Flags.Storage + "\nMinGain=" + std::to_string(Flags.MinGain) + "\n";
+		K += "Source=" + ScyndiSource + "\n"; // The file name ends up in the translation
+		K += "Code:" + md5(Normalize(src)) + "\n";
+		return md5(K);
+	}
+
+	std::string BuildCacheKey(GINIE PrjData, JT_Dir Res, std::string SourceKey, GINIE Recorded, bool debug, bool& fail) {
+		if (!Enabled || !SourceKey.size() || !Recorded) return "";
+		std::string K{ "Source=" + SourceKey + "\n" };
+		for (auto& I : *Recorded->List("Build", "RealIncludes")) {
+			if (!FileExists(I)) return "";
+			K += "Include:" + I + "=" + md5(Normalize(FLoadString(I))) + "\n";
+		}
+		for (auto& I : *Recorded->List("Build", "JCRIncludes")) {
+			if (!Res->EntryExists(I)) return "";
+			K += "JCRInclude:" + I + "=" + md5(Normalize(Res->GetString(I))) + "\n";
+		}
+		for (auto& D : *Recorded->List("Build", "Dependencies")) {
+			std::string Interface{ "" };
+			if (!DependencyInterface(PrjData, Res, D, debug, Interface, fail)) return "";
+			K += "Use:" + D + "=" + Interface + "\n";
+		}
+		return md5(K);
+	}
+
+	// Temp files must be unique to this process, as other builds sharing the cache can store the same key at the same time.
+	static std::string TmpFile(std::string File) {
+		static std::random_device RD{};
+		static auto Salt{ TrSPrintF("%d_%08x", (int)ScyndiPID(), (unsigned int)RD()) };
+		static Slyvina::uint64 Count{ 0 };
+		return File + "." + Salt + "_" + std::to_string(Count++) + ".tmp";
+	}
+
+	// Renaming is atomic, so other builds sharing this cache never see a half written file
+	static bool MoveIn(std::string Tmp, std::string CF, std::string What) {
+		std::error_code ec, ec2;
+		fs::rename(Tmp, CF, ec);
+		if (ec) {
+			fs::remove(Tmp, ec2);
+			QCol->Warn("Could not store " + What + " in the build cache: " + ec.message());
+			return false;
+		}
+		return true;
+	}
+
+	GINIE BuildCacheRecorded(std::string SourceKey) {
+		if (!Enabled || !SourceKey.size()) return nullptr;
+		auto RF{ RecordFile(SourceKey) };
+		std::error_code ec;
+		if (!fs::exists(RF, ec)) return nullptr;
+		fs::last_write_time(RF, fs::file_time_type::clock::now(), ec); // Eviction goes by least recent use
+		return ParseGINIE(FLoadString(RF));
+	}
+
+	void BuildCacheRecord(std::string SourceKey, GINIE Recorded) {
+		if (!Enabled || !SourceKey.size() || !Recorded) return;
+		auto Deps{ ParseGINIE("[Build]\n") };
+		for (auto L : { "RealIncludes", "JCRIncludes", "Dependencies" }) for (auto& I : *Recorded->List("Build", L)) Deps->Add("Build", L, I);
+		auto RF{ RecordFile(SourceKey) };
+		auto Tmp{ TmpFile(RF) };
+		std::error_code ec;
+		fs::create_directories(fs::path(RF).parent_path(), ec);
+		if (ec) { QCol->Warn("Could not store the dependencies in the build cache: " + ec.message()); return; }
+		SaveString(Tmp, Deps->UnParse());
+		MoveIn(Tmp, RF, "the dependencies");
+	}
+
+	bool BuildCacheFetch(std::string Key, std::string OutputFile) {
+		if (!Enabled) return false;
+		if (!Key.size()) { Misses++; return false; } // Nothing recorded for the source yet, or an include is gone
+		auto CF{ CacheFile(Key) };
+		std::error_code ec;
+		if (!fs::exists(CF, ec)) { Misses++; return false; }
+		fs::copy_file(CF, OutputFile, fs::copy_options::overwrite_existing, ec);
+		if (ec) {
+			QCol->Warn("Could not get " + OutputFile + " from the build cache: " + ec.message());
+			Misses++;
+			return false;
+		}
+		auto Now{ fs::file_time_type::clock::now() };
+		fs::last_write_time(OutputFile, Now, ec); // Keeps the stat based check in Compile() fast next time
+		fs::last_write_time(CF, Now, ec); // Eviction goes by least recent use
+		Hits++;
+		return true;
+	}
+
+	void BuildCacheStore(std::string Key, std::string OutputFile) {
+		if (!Enabled || !Key.size()) return;
+		auto CF{ CacheFile(Key) };
+		auto Tmp{ TmpFile(CF) };
+		std::error_code ec;
+		fs::create_directories(fs::path(CF).parent_path(), ec);
+		if (!ec) fs::copy_file(OutputFile, Tmp, fs::copy_options::overwrite_existing, ec);
+		if (ec) {
+			QCol->Warn("Could not store " + OutputFile + " in the build cache: " + ec.message());
+			return;
+		}
+		if (MoveIn(Tmp, CF, OutputFile)) Stored++;
+	}
+
+	void BuildCacheFinish() {
+		if (!Enabled) return;
+		std::error_code ec;
+		std::vector<std::pair<fs::file_time_type, fs::path>> Entries{};
+		uintmax_t Total{ 0 };
+		for (auto E{ fs::recursive_directory_iterator(Directory, ec) }; (!ec) && E != fs::recursive_directory_iterator(); E.increment(ec)) {
+			if (!E->is_regular_file(ec)) continue;
+			auto Ext{ Upper(E->path().extension().string()) };
+			if (Ext != ".STB" && Ext != ".DEPS") continue;
+			Total += E->file_size(ec);
+			Entries.push_back({ E->last_write_time(ec), E->path() });
+		}
+		if (Total > MaxSize) {
+			std::sort(Entries.begin(), Entries.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+			for (auto& E : Entries) {
+				if (Total <= MaxSize) break;
+				auto sz{ fs::file_size(E.second, ec) };
+				if (fs::remove(E.second, ec)) { Total -= sz; Evicted++; }
+			}
+		}
+		QCol->Doing("Cache hits", Hits);
+		QCol->Doing("Cache misses", Misses);
+		if (Stored) QCol->Doing("Cache stored", Stored);
+		if (Evicted) QCol->Doing("Cache evicted", Evicted);
+		QCol->Doing("Cache size", TrSPrintF("%.1f MB", (double)Total / (1024 * 1024)));
+	}
+}
@@ -0,0 +1,81 @@
+// License:
+// 
+// Scyndi
+// Build Cache (header)
+// 
+// 
+// 
+// 	(c) Jeroen P. Broks, 2026
+// 
+// 		This program is free software: you can redistribute it and/or modify
+// 		it under the terms of the GNU General Public License as published by
+// 		the Free Software Foundation, either version 3 of the License, or
+// 		(at your option) any later version.
+// 
+// 		This program is distributed in the hope that it will be useful,
+// 		but WITHOUT ANY WARRANTY; without even the implied warranty of
+// 		MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// 		GNU General Public License for more details.
+// 		You should have received a copy of the GNU General Public License
+// 		along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// 
+// 	Please note that some references to data like pictures or audio, do not automatically
+// 	fall under this licenses. Mostly this is noted in the respective files.
+// 
+// Version: 26.10.19
+// End License
+
+#pragma once
+#include <string>
+#include <SlyvGINIE.hpp>
+#include <JCR6_Core.hpp>
+
+namespace Scyndi {
+
+	/// <summary>
+	/// Reads the [Cache] section of the project. When no directory is set there, the cache is not used at all.
+	/// </summary>
+	void InitBuildCache(Slyvina::Units::GINIE PrjData);
+	bool BuildCacheEnabled();
+
+	/// <summary>
+	/// Everything besides the sources that makes a difference to the STB of a source.
+	/// </summary>
+	struct BuildCacheFlags {
+		bool
+			Debug{ false },
+			Release{ false },
+			LineCalls{ false };
+		std::string Storage{ "" };
+		int MinGain{ 10 };
+		size_t Inline{ 0 };
+	};
+
+	/// <summary>
+	/// Key of the source itself and the flags. Under this key the cache keeps the includes and dependencies the translator recorded for the source, 
+	/// so the full key can be worked out without translating.
+	/// </summary>
+	std::string BuildCacheSourceKey(std::string ScyndiSource, std::string src, const BuildCacheFlags& Flags);
+
+	/// <summary>
+	/// Key under which the STB of a source is stored in the cache: the source key, and the current state of the includes and dependencies 
+	/// listed in the [Build] section of Recorded. That's either the Configuration.ini of a translation, or what BuildCacheRecorded() returns.
+	/// Returns an empty string when no key could be determined (the file will then just be translated without the cache).
+	/// fail will be set when compiling a dependency failed.
+	/// </summary>
+	std::string BuildCacheKey(Slyvina::Units::GINIE PrjData, Slyvina::JCR6::JT_Dir Res, std::string SourceKey, Slyvina::Units::GINIE Recorded, bool debug, bool& fail);
+
+	/// <summary>
+	/// The includes and dependencies stored with BuildCacheRecord() for a source key, or nullptr when there are none.
+	/// </summary>
+	Slyvina::Units::GINIE BuildCacheRecorded(std::string SourceKey);
+	void BuildCacheRecord(std::string SourceKey, Slyvina::Units::GINIE Recorded);
+
+	bool BuildCacheFetch(std::string Key, std::string OutputFile);
+	void BuildCacheStore(std::string Key, std::string OutputFile);
+
+	/// <summary>
+	/// Evicts the least recently used entries when the cache got too big, and shows the statistics.
+	/// </summary>
+	void BuildCacheFinish();
+}
@@ -47,5 +47,9 @@ namespace Scyndi {
 	bool WantProject() { return !_Args.bool_flags["sl"]; }
 	bool WantForce() { return _Args.bool_flags["force"]; }
 	bool WantDebug() { return _Args.bool_flags["dbg"]; }
+	bool WantDeterministic() { return _Args.bool_flags["deterministic"]; }
+	bool WantWatch() { return _Args.bool_flags["watch"]; }
+	bool WantRelease() { return _Args.bool_flags["release"]; }
+	bool WantTimings() { return _Args.bool_flags["timings"]; }
 
 }
\ No newline at end of file
@@ -33,4 +33,8 @@ namespace Scyndi {
 	bool WantProject();
 	bool WantForce();
 	bool WantDebug();
+	bool WantDeterministic();
+	bool WantWatch();
+	bool WantRelease();
+	bool WantTimings();
 }
\ No newline at end of file
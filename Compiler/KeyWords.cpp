@@ -40,6 +40,8 @@ namespace Scyndi {
 		"CLASS",
 		"GROUP",
 		"NEW",
+		"POOLED",
+		"RECORD",
 
 		// Import
 		"EXTERN","LOCEXTERM",
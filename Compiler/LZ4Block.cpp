@@ -0,0 +1,157 @@
+// License:
+// 
+// Scyndi
+// LZ4 block storage
+// 
+// 
+// 
+// 	(c) Jeroen P. Broks, 2026
+// 
+// 		This program is free software: you can redistribute it and/or modify
+// 		it under the terms of the GNU General Public License as published by
+// 		the Free Software Foundation, either version 3 of the License, or
+// 		(at your option) any later version.
+// 
+// 		This program is distributed in the hope that it will be useful,
+// 		but WITHOUT ANY WARRANTY; without even the implied warranty of
+// 		MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// 		GNU General Public License for more details.
+// 		You should have received a copy of the GNU General Public License
+// 		along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// 
+// 	Please note that some references to data like pictures or audio, do not automatically
+// 	fall under this licenses. Mostly this is noted in the respective files.
+// 
+// Version: 26.10.19
+// End License
+#include <cstring>
+#include <cstdint>
+#include <vector>
+
+#include <JCR6_Core.hpp>
+
+#include "LZ4Block.hpp"
+
+using namespace Slyvina::JCR6;
+
+// A sequence is a token (4 bits literal length, 4 bits match length - 4), extra literal length bytes, the literals,
+// a 16 bit little endian offset and extra match length bytes. The last 5 bytes are always literals.
+// This is the LZ4 block format (no frames), so data written here can be read by any LZ4 block decoder.
+
+namespace Scyndi {
+
+	static constexpr size_t
+		MinMatch{ 4 },
+		LastLiterals{ 5 },
+		MFLimit{ 12 }, // No match may start in the last 12 bytes
+		MaxOffset{ 65535 },
+		HashLog{ 12 };
+
+	static inline uint32_t Read32(const char* p) { uint32_t r; memcpy(&r, p, 4); return r; }
+	static inline uint32_t Hash(uint32_t v) { return (v * 2654435761U) >> (32 - HashLog); }
+
+	size_t LZ4BlockCompress(const char* src, size_t srcSize, char* dst, size_t dstCap) {
+		std::vector<uint32_t> Table(1 << HashLog, 0);
+		size_t
+			ip{ 0 },
+			anchor{ 0 },
+			op{ 0 };
+		auto PutLength{ [&](size_t len)->bool {
+			for (; len >= 255; len -= 255) { if (op >= dstCap) return false; dst[op++] = (char)255; }
+			if (op >= dstCap) return false;
+			dst[op++] = (char)len;
+			return true;
+		} };
+		auto Sequence{ [&](size_t litlen, size_t matchlen, size_t offset, bool last)->bool {
+			if (op >= dstCap) return false;
+			auto token{ op++ };
+			auto ml{ last ? 0 : matchlen - MinMatch };
+			dst[token] = (char)(((litlen < 15 ? litlen : 15) << 4) | (ml < 15 ? ml : 15));
+			if (litlen >= 15 && !PutLength(litlen - 15)) return false;
+			if (op + litlen > dstCap) return false;
+			memcpy(dst + op, src + anchor, litlen);
+			op += litlen;
+			if (last) return true;
+			if (op + 2 > dstCap) return false;
+			dst[op++] = (char)(offset & 255);
+			dst[op++] = (char)(offset >> 8);
+			if (ml >= 15 && !PutLength(ml - 15)) return false;
+			return true;
+		} };
+		if (srcSize >= MFLimit + 1) {
+			auto limit{ srcSize - MFLimit };
+			ip = 1;
+			Table[Hash(Read32(src))] = 0;
+			while (ip < limit) {
+				auto h{ Hash(Read32(src + ip)) };
+				size_t ref{ Table[h] };
+				Table[h] = (uint32_t)ip;
+				if (ip - ref > MaxOffset || ref >= ip || Read32(src + ref) != Read32(src + ip)) { ip++; continue; }
+				// Extend backwards over the pending literals, then forwards
+				while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1]) { ip--; ref--; }
+				auto len{ MinMatch };
+				while (ip + len < srcSize - LastLiterals && src[ip + len] == src[ref + len]) len++;
+				if (!Sequence(ip - anchor, len, ip - ref, false)) return 0;
+				ip += len;
+				anchor = ip;
+				if (ip < limit) Table[Hash(Read32(src + ip - 2))] = (uint32_t)(ip - 2);
+			}
+		}
+		if (!Sequence(srcSize - anchor, 0, 0, true)) return 0;
+		return op;
+	}
+
+	bool LZ4BlockExpand(const char* src, size_t srcSize, char* dst, size_t dstSize) {
+		size_t ip{ 0 }, op{ 0 };
+		auto GetLength{ [&](size_t& len)->bool {
+			unsigned char b;
+			do {
+				if (ip >= srcSize) return false;
+				b = (unsigned char)src[ip++];
+				len += b;
+			} while (b == 255);
+			return true;
+		} };
+		while (ip < srcSize) {
+			auto token{ (unsigned char)src[ip++] };
+			size_t litlen{ (size_t)(token >> 4) };
+			if (litlen == 15 && !GetLength(litlen)) return false;
+			if (ip + litlen > srcSize || op + litlen > dstSize) return false;
+			memcpy(dst + op, src + ip, litlen);
+			ip += litlen;
+			op += litlen;
+			if (ip == srcSize) break; // Last sequence has no match
+			if (ip + 2 > srcSize) return false;
+			size_t offset{ (size_t)(unsigned char)src[ip] | ((size_t)(unsigned char)src[ip + 1] << 8) };
+			ip += 2;
+			if (offset == 0 || offset > op) return false;
+			size_t matchlen{ (size_t)(token & 15) };
+			if (matchlen == 15 && !GetLength(matchlen)) return false;
+			matchlen += MinMatch;
+			if (op + matchlen > dstSize) return false;
+			auto from{ op - offset };
+			if (offset >= matchlen) {
+				memcpy(dst + op, dst + from, matchlen);
+				op += matchlen;
+			} else for (size_t i = 0; i < matchlen; i++) dst[op++] = dst[from + i]; // Overlapping copy repeats the pattern
+		}
+		return op == dstSize;
+	}
+
+	static bool LZ4Compress(char* Uncompressed, char* Compressed, size_t size_uncompressed, size_t& size_compressed) {
+		size_compressed = LZ4BlockCompress(Uncompressed, size_uncompressed, Compressed, size_uncompressed);
+		return size_compressed > 0;
+	}
+
+	static bool LZ4Expand(char* Compressed, char* UnCompressed, size_t size_compressed, size_t size_uncompressed) {
+		return LZ4BlockExpand(Compressed, size_compressed, UnCompressed, size_uncompressed);
+	}
+
+	void init_lz4block() {
+		JC_CompressDriver Drv;
+		Drv.Compress = LZ4Compress;
+		Drv.Expand = LZ4Expand;
+		Drv.Name = LZ4BlockStorage;
+		RegisterCompressDriver(Drv);
+	}
+}
@@ -0,0 +1,50 @@
+// License:
+// 
+// Scyndi
+// LZ4 block storage (header)
+// 
+// 
+// 
+// 	(c) Jeroen P. Broks, 2026
+// 
+// 		This program is free software: you can redistribute it and/or modify
+// 		it under the terms of the GNU General Public License as published by
+// 		the Free Software Foundation, either version 3 of the License, or
+// 		(at your option) any later version.
+// 
+// 		This program is distributed in the hope that it will be useful,
+// 		but WITHOUT ANY WARRANTY; without even the implied warranty of
+// 		MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// 		GNU General Public License for more details.
+// 		You should have received a copy of the GNU General Public License
+// 		along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// 
+// 	Please note that some references to data like pictures or audio, do not automatically
+// 	fall under this licenses. Mostly this is noted in the respective files.
+// 
+// Version: 26.10.19
+// End License
+
+#pragma once
+#include <string>
+
+namespace Scyndi {
+
+	/// <summary>
+	/// Storage method name of the LZ4 block codec in JCR6
+	/// </summary>
+	const std::string LZ4BlockStorage{ "lz4block" };
+
+	/// <summary>
+	/// Compresses into the LZ4 block format. Nothing is written beyond dst+dstCap.
+	/// </summary>
+	/// <returns>The compressed size, or 0 when the result doesn't fit in dstCap</returns>
+	size_t LZ4BlockCompress(const char* src, size_t srcSize, char* dst, size_t dstCap);
+	/// <returns>false if the data is damaged or doesn't expand to precisely dstSize bytes</returns>
+	bool LZ4BlockExpand(const char* src, size_t srcSize, char* dst, size_t dstSize);
+
+	/// <summary>
+	/// Registers the codec as a JCR6 compression driver. Decompressing is several times faster than zlib, at the price of a less tight compression.
+	/// </summary>
+	void init_lz4block();
+}
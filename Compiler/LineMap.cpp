@@ -0,0 +1,134 @@
+// License:
+// 
+// Scyndi
+// Line maps
+// 
+// 
+// 
+// 	(c) Jeroen P. Broks, 2026
+// 
+// 		This program is free software: you can redistribute it and/or modify
+// 		it under the terms of the GNU General Public License as published by
+// 		the Free Software Foundation, either version 3 of the License, or
+// 		(at your option) any later version.
+// 
+// 		This program is distributed in the hope that it will be useful,
+// 		but WITHOUT ANY WARRANTY; without even the implied warranty of
+// 		MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// 		GNU General Public License for more details.
+// 		You should have received a copy of the GNU General Public License
+// 		along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// 
+// 	Please note that some references to data like pictures or audio, do not automatically
+// 	fall under this licenses. Mostly this is noted in the respective files.
+// 
+// Version: 26.10.19
+// End License
+
+#include <algorithm>
+#include <SlyvString.hpp>
+
+#include "LineMap.hpp"
+
+using namespace Slyvina;
+using namespace Slyvina::Units;
+
+namespace Scyndi {
+
+	void _LineMap::Add(uint32 LuaLine, std::string File, uint32 Line) {
+		if (Runs.size() && Runs.back().LuaLine >= LuaLine) return;
+		uint32 FI{ 0 };
+		while (FI < Files.size() && Files[FI] != File) FI++;
+		if (FI == Files.size()) Files.push_back(File);
+		if (Runs.size() && Runs.back().File == FI && Runs.back().Line == Line) return;
+		Runs.push_back({ LuaLine,FI,Line });
+	}
+
+	bool _LineMap::Lookup(uint32 LuaLine, std::string& File, uint32& Line) {
+		auto R{ std::upper_bound(Runs.begin(), Runs.end(), LuaLine, [](uint32 L, const Run& R) { return L < R.LuaLine; }) };
+		if (R == Runs.begin()) return false;
+		R--;
+		File = Files[R->File];
+		Line = R->Line;
+		return true;
+	}
+
+	static void PutInt(std::string& Buf, uint32 i) {
+		for (int b = 0; b < 4; b++) Buf += (char)((i >> (b * 8)) & 255);
+	}
+
+	static void PutString(std::string& Buf, std::string S) {
+		PutInt(Buf, (uint32)S.size());
+		Buf += S;
+	}
+
+	std::string _LineMap::Serialize() {
+		std::string ret{ "SLMP" };
+		PutInt(ret, 1);
+		PutString(ret, Chunk);
+		PutInt(ret, (uint32)Files.size());
+		for (auto& F : Files) PutString(ret, F);
+		PutInt(ret, (uint32)Runs.size());
+		for (auto& R : Runs) { PutInt(ret, R.LuaLine); PutInt(ret, R.File); PutInt(ret, R.Line); }
+		return ret;
+	}
+
+	std::string LineMapChunk(std::string SourceFile) { return "@" + StripExt(SourceFile) + ".lua"; }
+
+	std::string MapTrace(std::string Trace, std::map<std::string, LineMap>& Maps) {
+		for (auto& M : Maps) {
+			if (M.first.size() < 2 || M.first[0] != '@') continue;
+			auto Src{ M.first.substr(1) + ":" };
+			size_t p{ 0 };
+			while ((p = Trace.find(Src, p)) != std::string::npos) {
+				auto d{ p + Src.size() }, e{ d };
+				while (e < Trace.size() && Trace[e] >= '0' && Trace[e] <= '9') e++;
+				std::string File{ "" };
+				uint32 Line{ 0 };
+				// More than 9 digits can't be a line of a chunk, and would not even fit in a uint32
+				if (e == d || e - d > 9 || !M.second->Lookup((uint32)std::stoul(Trace.substr(d, e - d)), File, Line)) { p = d; continue; }
+				auto Pos{ File + ":" + std::to_string(Line) };
+				Trace = Trace.substr(0, p) + Pos + Trace.substr(e);
+				p += Pos.size();
+			}
+		}
+		return Trace;
+	}
+
+	bool ReadLineMaps(const char* Buf, size_t Size, std::map<std::string, LineMap>& Maps) {
+		size_t Pos{ 0 };
+		bool Ok{ true };
+		auto GetInt{ [&]()->uint32 {
+			if (Pos + 4 > Size) { Ok = false; return 0; }
+			uint32 ret{ 0 };
+			for (int b = 0; b < 4; b++) ret |= ((uint32)(unsigned char)Buf[Pos++]) << (b * 8);
+			return ret;
+		} };
+		auto GetString{ [&]()->std::string {
+			auto l{ GetInt() };
+			if (!Ok || Pos + l > Size) { Ok = false; return ""; }
+			std::string ret{ Buf + Pos, l };
+			Pos += l;
+			return ret;
+		} };
+		while (Pos < Size) {
+			if (Pos + 8 > Size || std::string(Buf + Pos, 4) != "SLMP") return false;
+			Pos += 4;
+			if (GetInt() != 1) return false;
+			auto M{ NewLineMap(GetString()) };
+			auto FC{ GetInt() };
+			for (uint32 i = 0; Ok && i < FC; i++) M->Files.push_back(GetString());
+			auto RC{ GetInt() };
+			if (!Ok || (size_t)RC * 12 > Size - Pos) return false;
+			for (uint32 i = 0; i < RC; i++) {
+				_LineMap::Run R{};
+				R.LuaLine = GetInt(); R.File = GetInt(); R.Line = GetInt();
+				if (R.File >= M->Files.size()) return false;
+				M->Runs.push_back(R);
+			}
+			if (!Ok) return false;
+			Maps[M->Chunk] = M;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,83 @@
+// License:
+// 
+// Scyndi
+// Line maps
+// 
+// 
+// 
+// 	(c) Jeroen P. Broks, 2026
+// 
+// 		This program is free software: you can redistribute it and/or modify
+// 		it under the terms of the GNU General Public License as published by
+// 		the Free Software Foundation, either version 3 of the License, or
+// 		(at your option) any later version.
+// 
+// 		This program is distributed in the hope that it will be useful,
+// 		but WITHOUT ANY WARRANTY; without even the implied warranty of
+// 		MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// 		GNU General Public License for more details.
+// 		You should have received a copy of the GNU General Public License
+// 		along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// 
+// 	Please note that some references to data like pictures or audio, do not automatically
+// 	fall under this licenses. Mostly this is noted in the respective files.
+// 
+// Version: 26.10.19
+// End License
+
+#pragma once
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <Slyvina.hpp>
+
+namespace Scyndi {
+
+	/// <summary>
+	/// Maps the lines of a Lua translation back to the Scyndi files and lines they came from.
+	/// Only the Lua lines where the mapping changes are stored. Every line after that maps to the same Scyndi line, till the next change.
+	/// 
+	/// Serialized layout (all numbers are 32 bit little endian, strings are a length followed by the characters):
+	/// "SLMP" Version Chunk
+	/// Files: count, then the file names
+	/// Runs: count, then per run: Lua line, file, Scyndi line
+	/// 
+	/// Chunk is the chunk name the translation was compiled with (so what debug info calls the 'source'). 
+	/// Several maps can be stored back to back, which is what the linker does.
+	/// </summary>
+	class _LineMap {
+	public:
+		struct Run { Slyvina::uint32 LuaLine{ 0 }, File{ 0 }, Line{ 0 }; };
+		std::string Chunk{ "" };
+		std::vector<std::string> Files{};
+		std::vector<Run> Runs{};
+
+		/// <summary>
+		/// Lua lines must come in ascending order. When a Lua line already has a mapping, that one stays.
+		/// </summary>
+		void Add(Slyvina::uint32 LuaLine, std::string File, Slyvina::uint32 Line);
+		/// <returns>false if the Lua line comes before everything in the map</returns>
+		bool Lookup(Slyvina::uint32 LuaLine, std::string& File, Slyvina::uint32& Line);
+		std::string Serialize();
+	};
+	typedef std::shared_ptr<_LineMap> LineMap;
+
+	inline LineMap NewLineMap(std::string Chunk) { auto ret{ std::make_shared<_LineMap>() }; ret->Chunk = Chunk; return ret; }
+
+	/// <summary>
+	/// Reads all maps in Buf. They are keyed by their chunk names.
+	/// </summary>
+	/// <returns>false if the data is damaged. The maps read before the damage are still in Maps.</returns>
+	bool ReadLineMaps(const char* Buf, size_t Size, std::map<std::string, LineMap>& Maps);
+
+	/// <summary>
+	/// The chunk name a translation is compiled with. Errors from Lua then at least point to the right script.
+	/// </summary>
+	std::string LineMapChunk(std::string SourceFile);
+
+	/// <summary>
+	/// Replaces all Lua positions ("Script/Name.lua:123") in an error message or traceback by the Scyndi positions they came from.
+	/// </summary>
+	std::string MapTrace(std::string Trace, std::map<std::string, LineMap>& Maps);
+}
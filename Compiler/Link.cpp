@@ -0,0 +1,218 @@
+// License:
+// 
+// Scyndi
+// Linker
+// 
+// 
+// 
+// 	(c) Jeroen P. Broks, 2026
+// 
+// 		This program is free software: you can redistribute it and/or modify
+// 		it under the terms of the GNU General Public License as published by
+// 		the Free Software Foundation, either version 3 of the License, or
+// 		(at your option) any later version.
+// 
+// 		This program is distributed in the hope that it will be useful,
+// 		but WITHOUT ANY WARRANTY; without even the implied warranty of
+// 		MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// 		GNU General Public License for more details.
+// 		You should have received a copy of the GNU General Public License
+// 		along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// 
+// 	Please note that some references to data like pictures or audio, do not automatically
+// 	fall under this licenses. Mostly this is noted in the respective files.
+// 
+// Version: 26.10.19
+// End License
+#include <functional>
+#include <map>
+#include <vector>
+
+#include <SlyvString.hpp>
+#include <SlyvStream.hpp>
+#include <SlyvQCol.hpp>
+#include <SlyvTime.hpp>
+#include <SlyvMD5.hpp>
+
+#include <JCR6_Core.hpp>
+#include <JCR6_Write.hpp>
+
+#include "Link.hpp"
+#include "../ScyndiVersion.hpp"
+
+using namespace Slyvina;
+using namespace Slyvina::Units;
+using namespace Slyvina::JCR6;
+
+namespace Scyndi {
+
+	struct _LinkScript {
+		std::string Name{ "" }, STB{ "" };
+		GINIE Data{ nullptr };
+		std::vector<std::string> Deps{};
+		uint32 Offset{ 0 }, Size{ 0 };
+		bool Used{ false }; // Another script #USEs this one
+	};
+
+	class _Linker {
+	private:
+		ProjectModel M;
+		bool debug;
+		std::string DepSTB(std::string D) { return STBFile(D + ".Scyndi", debug); } // Entry of the translation of dependency D
+	public:
+		std::map<std::string, _LinkScript> Scripts{};
+		std::vector<_LinkScript*> Order{};
+		std::string Error{ "" };
+
+		bool Add(std::string Name, std::string STB) {
+			auto& S{ Scripts[Upper(Name)] };
+			S.Name = Name;
+			S.STB = STB;
+			S.Data = STBConfig(STB);
+			if (!S.Data) { Error = "Could not read the configuration of " + STB; return false; }
+			for (auto& D : *S.Data->List("Build", "Dependencies")) S.Deps.push_back(Upper(D));
+			for (auto& D : *S.Data->List("Build", "Dependencies")) {
+				if (Scripts.count(Upper(D))) continue;
+				if (M->Res->EntryExists(D + ".Scyndi")) continue; // Will be added by Collect()
+				// Dependencies only available as an STB (precompiled libraries)
+				if (!M->Res->EntryExists(DepSTB(D))) { Error = "No translation found for dependency " + D + " of " + Name; return false; }
+				if (!Add(D, M->Res->Entry(DepSTB(D))->MainFile)) return false;
+			}
+			return true;
+		}
+
+		bool Collect() {
+			for (auto SD : *M->Res->Entries()) {
+				if (Upper(ExtractExt(SD->Name())) != "SCYNDI" || Scripts.count(Upper(StripExt(SD->Name())))) continue;
+				if (!Add(StripExt(SD->Name()), STBFile(SD->MainFile, debug))) return false;
+			}
+			return true;
+		}
+
+		// Depth first, so every script ends up after all its dependencies
+		bool Sort() {
+			std::map<std::string, byte> State{}; // 1 = busy, 2 = done
+			std::function<bool(std::string)> Visit{ [&](std::string K)->bool {
+				if (State[K] == 2) return true;
+				if (State[K] == 1) { Error = "Circular #USE involving " + Scripts[K].Name; return false; }
+				State[K] = 1;
+				for (auto& D : Scripts[K].Deps) { Scripts[D].Used = true; if (!Visit(D)) return false; }
+				State[K] = 2;
+				Order.push_back(&Scripts[K]);
+				return true;
+			} };
+			for (auto& S : Scripts) if (!Visit(S.first)) return false;
+			return true;
+		}
+
+		std::string Digest(std::string Storage) {
+			std::string D{ QVersion.Version(true) + "\n" + Storage + "\n" };
+			for (auto S : Order) {
+				auto BD{ S->Data->Value("Build", "Digest") };
+				D += S->Name + "=" + (BD.size() ? BD : std::to_string(FileTimeStamp(S->STB))) + "\n";
+			}
+			return md5(D);
+		}
+
+		// A script can be left out of the boot when it's only needed by other scripts, and all it exports goes through Scyndi.Globals or Scyndi.Class. 
+		// The runtime can then see when it's needed. Pure Lua and EXTERN globals go around Scyndi, so there's no telling when those get accessed.
+		bool CanBeLazy(_LinkScript* S) {
+			if (!S->Used) return false;
+			auto Exports{ S->Data->List("Globals", "-List-") };
+			if (!Exports->size()) return false;
+			for (auto& G : *Exports) {
+				auto Sub{ Upper(S->Data->Value("Globals", G)) };
+				if (Prefixed(Sub, "SCYNDI.GLOBALS[") || Prefixed(Sub, "SCYNDI.CLASS[")) continue;
+				return false;
+			}
+			return true;
+		}
+
+		_Linker(ProjectModel _M, bool _debug) { M = _M; debug = _debug; }
+	};
+
+	static void PutInt(std::string& Buf, uint32 i) {
+		for (int b = 0; b < 4; b++) Buf += (char)((i >> (b * 8)) & 255);
+	}
+
+	static void PutString(std::string& Buf, std::string S) {
+		PutInt(Buf, (uint32)S.size());
+		Buf += S;
+	}
+
+	bool LinkProject(ProjectModel M, bool force, bool debug) {
+		auto Bundle{ M->PrjData->Value("Link", "Bundle") };
+		if (!Bundle.size()) return true;
+		if (debug) Bundle = StripExt(Bundle) + ".Debug." + ExtractExt(Bundle);
+		auto Storage{ M->PrjData->Value("Link", "Storage") }; if (!Storage.size()) Storage = "Store";
+		QCol->Doing("Linking", Bundle);
+		_Linker L{ M,debug };
+		if (!(L.Collect() && L.Sort())) { QCol->Error(L.Error); return false; }
+		auto LinkDigest{ L.Digest(Storage + "; Lazy=" + M->PrjData->Value("Link", "Lazy") + "; STB list") };
+		if ((!force) && FileExists(Bundle)) {
+			auto Old{ JCR6_Dir(Bundle) };
+			if (Old && Old->EntryExists("Link/Configuration.ini") && ParseGINIE(Old->GetString("Link/Configuration.ini"))->Value("Link", "Digest") == LinkDigest) {
+				QCol->Doing("Bundle", "Up-to-date");
+				return true;
+			}
+		}
+		std::vector<char> Program{};
+		std::string LineMaps{ "" }; // Line maps are self contained, so they can just be put back to back
+		for (auto S : L.Order) {
+			auto J{ JCR6_Dir(S->STB) };
+			if (!J) { QCol->Error("Could not read " + S->STB + " (" + Last()->ErrorMessage + ")"); return false; }
+			auto BC{ J->Characters("ByteCode.lbc") };
+			S->Offset = (uint32)Program.size();
+			S->Size = (uint32)BC.size();
+			Program.insert(Program.end(), BC.begin(), BC.end());
+			if (J->EntryExists("LineMap.bin")) LineMaps += J->GetString("LineMap.bin");
+		}
+		auto Lazy{ Upper(M->PrjData->Value("Link", "Lazy")) == "TRUE" };
+		uint32 LazyCount{ 0 };
+		std::string Index{ "SLNK" };
+		PutInt(Index, 2);
+		PutInt(Index, (uint32)L.Order.size());
+		for (auto S : L.Order) {
+			uint32 Flags{ 0 };
+			if (Lazy && L.CanBeLazy(S)) { Flags |= LinkLazy; LazyCount++; }
+			PutString(Index, S->Name);
+			PutInt(Index, S->Offset);
+			PutInt(Index, S->Size);
+			PutInt(Index, Flags);
+		}
+		std::string Part{ "" };
+		uint32 Count{ 0 };
+		for (uint32 i = 0; i < L.Order.size(); i++) for (auto& G : *L.Order[i]->Data->List("Globals", "-List-")) {
+			PutString(Part, G);
+			PutInt(Part, i);
+			PutString(Part, L.Order[i]->Data->Value("Globals", G));
+			Count++;
+		}
+		PutInt(Index, Count); Index += Part; Part = ""; Count = 0;
+		for (uint32 i = 0; i < L.Order.size(); i++) for (auto& C : *L.Order[i]->Data->List("CLASSES", "CLASS")) {
+			PutString(Part, C);
+			PutInt(Part, i);
+			Count++;
+		}
+		PutInt(Index, Count); Index += Part;
+
+		auto Config{ ParseGINIE("[Link]\n") };
+		Config->Value("Link", "Compiler", "Scyndi " + QVersion.Version(true));
+		Config->Value("Link", "Debug", debug ? "TRUE" : "FALSE");
+		Config->Value("Link", "Scripts", std::to_string(L.Order.size()));
+		Config->Value("Link", "Lazy", std::to_string(LazyCount));
+		Config->Value("Link", "Digest", LinkDigest);
+		for (auto S : L.Order) Config->Add("Link", "STB", S->STB); // Where the scripts came from, in link order, so "quickscyndi -boot" can compare both layouts
+		auto UConfig{ Config->UnParse() };
+		auto JO{ CreateJCR6(Bundle) };
+		JO->AddChars(Program, "Link/Program.lbc", Storage);
+		JO->AddString(Index, "Link/Index.bin", "Store");
+		JO->AddString(UConfig, "Link/Configuration.ini", "Store");
+		if (LineMaps.size()) JO->AddString(LineMaps, "Link/LineMap.bin", Storage);
+		JO->Close();
+		if (Last()->Error) { QCol->Error("Writing " + Bundle + " failed (" + Last()->ErrorMessage + ")"); return false; }
+		QCol->Doing("Linked", TrSPrintF("%d scripts; %d bytes of bytecode", (int)L.Order.size(), (int)Program.size()));
+		if (Lazy) QCol->Doing("Lazy", TrSPrintF("%d scripts are loaded on demand", (int)LazyCount));
+		return true;
+	}
+}
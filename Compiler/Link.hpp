@@ -0,0 +1,55 @@
+// License:
+// 
+// Scyndi
+// Linker (header)
+// 
+// 
+// 
+// 	(c) Jeroen P. Broks, 2026
+// 
+// 		This program is free software: you can redistribute it and/or modify
+// 		it under the terms of the GNU General Public License as published by
+// 		the Free Software Foundation, either version 3 of the License, or
+// 		(at your option) any later version.
+// 
+// 		This program is distributed in the hope that it will be useful,
+// 		but WITHOUT ANY WARRANTY; without even the implied warranty of
+// 		MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// 		GNU General Public License for more details.
+// 		You should have received a copy of the GNU General Public License
+// 		along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// 
+// 	Please note that some references to data like pictures or audio, do not automatically
+// 	fall under this licenses. Mostly this is noted in the respective files.
+// 
+// Version: 26.10.19
+// End License
+
+#pragma once
+#include <string>
+#include "ScyndiProject.hpp"
+
+namespace Scyndi {
+
+	constexpr Slyvina::uint32 LinkLazy{ 1 };
+
+	/// <summary>
+	/// Writes all translations of a project into one JCR6 bundle (set with Bundle in the [Link] section of the project).
+	/// Link/Program.lbc holds the bytecode of all scripts back to back, in such an order that every script comes after the scripts it #USEs.
+	/// Link/Index.bin is the manifest telling where every script is in there, and which globals and classes each one of them brings.
+	/// 
+	/// Index.bin layout (all numbers are 32 bit little endian, strings are a length followed by the characters):
+	/// "SLNK" Version
+	/// Scripts: count, then per script: name, offset, size, flags
+	/// Globals: count, then per global: name, script, substitute
+	/// Classes: count, then per class: name, script
+	/// 
+	/// Link/LineMap.bin holds the line maps of all scripts that have one (see LineMap.hpp).
+	/// 
+	/// With Lazy=TRUE in [Link], scripts the runtime can load on demand get the LinkLazy flag. 
+	/// A loader should hand those to Scyndi.LinkLazy and announce their globals and classes with Scyndi.Provides. 
+	/// Their bytecode is then only loaded once one of those is accessed.
+	/// </summary>
+	/// <returns>false if linking failed</returns>
+	bool LinkProject(ProjectModel M, bool force = false, bool debug = false);
+}
@@ -55,11 +55,20 @@ extern "C" {
 #include <lauxlib.h>
 }
 
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
 #include <SlyvQCol.hpp>
 #include <SlyvString.hpp>
 #include <JCR6_Write.hpp>
 
+#include <zlib.h>
+
 #include "Translate.hpp"
+#include "LZ4Block.hpp"
+#include "Timings.hpp"
 
 
 using namespace Slyvina::Units;
@@ -67,10 +76,6 @@ using namespace Slyvina::JCR6;
 
 namespace Scyndi {
 
-	static bool err{ false };
-
-	std::shared_ptr<std::vector<char>> OutBuf{ nullptr };
-
 	static int LuaPaniek(lua_State* L) {
 		QCol->Error("Compiling Lua translation failed");
 		//std::string Trace{};
@@ -95,33 +100,121 @@ namespace Scyndi {
 		}
 		//Error("", false, true);
 		//exit(11);
-		err = true;
 		return 0;
 	}
 
-	static int DumpLua(lua_State* L, const void* p, size_t sz, void* ud) {
+#pragma region "Compile states"
+	// The Lua states in here only compile and dump, and never run anything. 
+	// Everything allocated while compiling is garbage as soon as the dump is done, so memory comes from a simple arena:
+	// Freeing is ignored and the entire arena is dropped at once when the state is recycled.
+	class _Arena {
+	private:
+		static constexpr size_t BlockSize{ 1024 * 1024 };
+		std::vector<std::unique_ptr<char[]>> Blocks{};
+		size_t Left{ 0 }, _Total{ 0 };
+		char* Pos{ nullptr };
+	public:
+		size_t Total() { return _Total; }
+		void* Get(size_t sz) {
+			sz = (sz + 15) & ~(size_t)15;
+			if (sz > Left) {
+				auto bs{ sz > BlockSize ? sz : BlockSize };
+				Blocks.push_back(std::unique_ptr<char[]>(new char[bs]));
+				Pos = Blocks.back().get();
+				Left = bs;
+				_Total += bs;
+			}
+			auto ret{ Pos };
+			Pos += sz;
+			Left -= sz;
+			return ret;
+		}
+		void Clear() { Blocks.clear(); Left = 0; _Total = 0; Pos = nullptr; }
+	};
+
+	static void* ArenaAlloc(void* ud, void* ptr, size_t osize, size_t nsize) {
+		auto A{ (_Arena*)ud };
+		if (nsize == 0) return nullptr;
+		if (ptr && nsize <= osize) return ptr;
+		auto ret{ A->Get(nsize) };
+		if (ptr) memcpy(ret, ptr, osize);
+		return ret;
+	}
 
-		auto pcp{ (char*)p };
-		for (size_t i = 0; i < sz; ++i) OutBuf->push_back(pcp[i]);
+	class _CompileState {
+	private:
+		static constexpr size_t RecycleSize{ 64 * 1024 * 1024 };
+		_Arena Arena{};
+		lua_State* _L{ nullptr };
+		void Close() { if (_L) lua_close(_L); _L = nullptr; Arena.Clear(); }
+	public:
+		lua_State* L() {
+			if (!_L) {
+				_L = lua_newstate(ArenaAlloc, &Arena);
+				lua_atpanic(_L, LuaPaniek);
+				lua_gc(_L, LUA_GCSTOP); // Pointless, as the arena doesn't reuse anything.
+			}
+			return _L;
+		}
+		// To be called after each compilation
+		void Done() {
+			if (!_L) return;
+			lua_settop(_L, 0);
+			if (Arena.Total() > RecycleSize) Close();
+		}
+		~_CompileState() { Close(); }
+	};
+
+	static _CompileState& CompileState() {
+		static thread_local _CompileState CS{};
+		return CS;
+	}
+#pragma endregion
+
+	static int DumpLua(lua_State* L, const void* p, size_t sz, void* ud) {
+		auto Buf{ (std::vector<char>*)ud };
+		auto pcp{ (const char*)p };
+		Buf->insert(Buf->end(), pcp, pcp + sz);
 		return 0;
 	}
 
-	bool SaveTranslation(Translation Trans, JT_Create Out,std::string Storage,bool Strip) {
-		err = false;
-		auto L{ luaL_newstate() };
+	// Compresses the data for real to see what it gains. Entries that don't shrink by at least MinGain percent are not worth the decompression at load time.
+	static std::string PickStorage(const char* Data, size_t Size, std::string Storage, int MinGain) {
+		if (Upper(Storage) == "STORE" || !Size) return "Store";
+		size_t Packed{ 0 };
+		if (Upper(Storage) == "ZLIB") {
+			uLongf zs{ compressBound((uLong)Size) };
+			std::vector<Bytef> Buf(zs);
+			if (compress2(Buf.data(), &zs, (const Bytef*)Data, (uLong)Size, Z_DEFAULT_COMPRESSION) != Z_OK) return "Store";
+			Packed = zs;
+		} else if (Upper(Storage) == Upper(LZ4BlockStorage)) {
+			std::vector<char> Buf(Size);
+			Packed = LZ4BlockCompress(Data, Size, Buf.data(), Size);
+			if (!Packed) return "Store";
+		} else return Size > 2048 ? Storage : "Store"; // No way to measure this one.
+		if (Packed >= Size || ((Size - Packed) * 100) / Size < (size_t)MinGain) return "Store";
+		return Storage;
+	}
+
+	bool SaveTranslation(Translation Trans, JT_Create Out,std::string Storage,bool Strip,int MinGain,JT_Create Symbols) {
+		auto& CS{ CompileState() };
+		auto L{ CS.L() };
 		auto source{ Trans->LuaSource };
+		std::vector<char> OutBuf{};
+		OutBuf.reserve(source.size());
 		QCol->Doing("Compiling", "Lua translation");
-		lua_atpanic(L, LuaPaniek);
-		luaL_openlibs(L);
-		luaL_loadstring(L, source.c_str());
-		//lua_call(L, 0, 0);
-		if (!err) {
-			OutBuf = std::make_shared < std::vector < char > >();
-			lua_dump(L, DumpLua, NULL, Strip?1:0);
-		}
-		if (!OutBuf->size()) {
+		PhaseTimer PTLoad{ "LoadString" };
+		auto Chunk{ Trans->Lines ? Trans->Lines->Chunk : std::string("=Translation") };
+		auto Status{ luaL_loadbuffer(L, source.c_str(), source.size(), Chunk.c_str()) };
+		PTLoad.Stop();
+		PhaseTimer PTDump{ "Dump" };
+		if (Status == LUA_OK) lua_dump(L, DumpLua, &OutBuf, (Strip || Symbols)?1:0);
+		std::vector<char> SymBuf{};
+		if (Status == LUA_OK && Symbols) lua_dump(L, DumpLua, &SymBuf, 0);
+		PTDump.Stop();
+		if (Status != LUA_OK || !OutBuf.size()) {
 			QCol->Error("Lua translation failed!");
-			LuaPaniek(L); // Test
+			if (Status != LUA_OK && lua_type(L, -1) == LUA_TSTRING) QCol->Doing("Lua", lua_tostring(L, -1));
 			QCol->LGreen("<source>\n");
 			auto Lines = Split(source,'\n');
 			for (size_t ln = 0; ln < Lines->size(); ln++) {
@@ -130,27 +223,32 @@ namespace Scyndi {
 				QCol->White("\n");
 			}
 			QCol->LGreen("</source>\n");
-			lua_close(L);
+			CS.Done();
 			return false;
 		}
+		CS.Done();
 		if (Out) {
+			PhaseTimer PT{ "Write" };
+			// Deciding the storage compresses every entry, so that's timed on its own. JCR6 compressing the chosen entries while adding them stays under "Write".
+			auto Pick{ [&](const char* Data, size_t Size) { PhaseTimer PTC{ "Compress" }; return PickStorage(Data, Size, Storage, MinGain); } };
 			QCol->Doing("Writing", "Bytecode");
-			if (OutBuf->size() > 2048)
-				Out->AddChars(*OutBuf, "ByteCode.lbc", Storage);
-			else
-				Out->AddChars(*OutBuf, "ByteCode.lbc");
-			QCol->Doing("Writing", "Translation");
-			if (source.size() > 2048)
-				Out->AddString(source, "Translation.lua", Storage);
-			else
-				Out->AddString(source, "Translation.lua");
+			Out->AddChars(OutBuf, "ByteCode.lbc", Pick(OutBuf.data(), OutBuf.size()));
+			// The line map is useless without the line info in the bytecode, so it goes where the unstripped bytecode goes.
+			auto LMap{ Trans->Lines ? Trans->Lines->Serialize() : std::string("") };
+			if (Symbols) {
+				QCol->Doing("Writing", "Symbols");
+				Symbols->AddChars(SymBuf, "ByteCode.lbc", Pick(SymBuf.data(), SymBuf.size()));
+				Symbols->AddString(source, "Translation.lua", Pick(source.c_str(), source.size()));
+				if (LMap.size()) Symbols->AddString(LMap, "LineMap.bin", Pick(LMap.c_str(), LMap.size()));
+			} else {
+				QCol->Doing("Writing", "Translation");
+				Out->AddString(source, "Translation.lua", Pick(source.c_str(), source.size()));
+				if (LMap.size()) Out->AddString(LMap, "LineMap.bin", Pick(LMap.c_str(), LMap.size()));
+			}
 			QCol->Doing("Writing", "Configuration");
 			Trans->Data->Value("Lua", "Version", TrSPrintF("%s.%s.%s", LUA_VERSION_MAJOR, LUA_VERSION_MINOR, LUA_VERSION_RELEASE));
 			auto UPD{ Trans->Data->UnParse() };
-			if (UPD.size() > 2048)
-				Out->AddString(UPD, "Configuration.ini", Storage);
-			else
-				Out->AddString(UPD, "Configuration.ini");
+			Out->AddString(UPD, "Configuration.ini", Pick(UPD.c_str(), UPD.size()));
 
 		} else {
 			//cout << "Writing:   " << dest << endl;
@@ -158,8 +256,25 @@ namespace Scyndi {
 			//for (auto ch : OutBuf) BT->Write(ch);
 			//BT->Close();
 		}
-		lua_close(L);
-		return !err;
+		return true;
+	}
+
+	bool ReplaceConfiguration(std::string STB, GINIE Data, std::string Storage, int MinGain) {
+		auto J{ JCR6_Dir(STB) };
+		if (!J) return false;
+		auto Tmp{ STB + ".tmp" };
+		auto Out{ CreateJCR6(Tmp) };
+		for (auto E : *J->Entries()) {
+			if (Upper(E->Name()) == "CONFIGURATION.INI") continue;
+			Out->AddChars(J->Characters(E->Name()), E->Name(), E->Storage());
+		}
+		auto UPD{ Data->UnParse() };
+		Out->AddString(UPD, "Configuration.ini", PickStorage(UPD.c_str(), UPD.size(), Storage, MinGain));
+		Out->Close();
+		J = nullptr;
+		std::remove(STB.c_str());
+		if (std::rename(Tmp.c_str(), STB.c_str())) { QCol->Error("Could not replace " + STB); return false; }
+		return true;
 	}
 
 }
@@ -54,5 +54,14 @@
 #include "Translate.hpp"
 
 namespace Scyndi {
-	bool SaveTranslation(Translation Trans, Slyvina::JCR6::JT_Create Out, std::string Storage,bool strip=false);
+	/// <summary>
+	/// Compiles the translation and writes it into Out. Entries are only stored with Storage when that makes them at least MinGain percent smaller.
+	/// When Symbols is set (release profile), Out only gets the stripped bytecode and the configuration. 
+	/// Symbols then gets the Lua source and the bytecode with all debug info, for when an error needs to be traced back.
+	/// </summary>
+	bool SaveTranslation(Translation Trans, Slyvina::JCR6::JT_Create Out, std::string Storage,bool strip=false,int MinGain=10,Slyvina::JCR6::JT_Create Symbols=nullptr);
+	/// <summary>
+	/// Writes the STB again with Data as its Configuration.ini. All other entries are copied as they are.
+	/// </summary>
+	bool ReplaceConfiguration(std::string STB, Slyvina::Units::GINIE Data, std::string Storage, int MinGain = 10);
 }
@@ -50,6 +50,9 @@
 // Version: 23.11.01
 // EndLic
 
+#include <cstdio>
+#include <cstdlib>
+
 #include <SlyvString.hpp>
 #include <SlyvStream.hpp>
 #include <SlyvQCol.hpp>
@@ -57,6 +60,7 @@
 #include <SlyvConInput.hpp>
 #include <SlyvGINIE.hpp>
 #include <SlyvAsk.hpp>
+#include <SlyvMD5.hpp>
 
 #include <JCR6_RealDir.hpp>
 #include <JCR6_Write.hpp>
@@ -64,6 +68,11 @@
 #include "ScyndiProject.hpp"
 #include "Translate.hpp"
 #include "SaveTranslation.hpp"
+#include "Config.hpp"
+#include "BuildCache.hpp"
+#include "Link.hpp"
+#include "Timings.hpp"
+#include "../ScyndiVersion.hpp"
 
 using namespace Slyvina::Units;
 using namespace Slyvina::JCR6;
@@ -100,22 +109,144 @@ namespace Scyndi {
 		return Compilation{ ret };
 	}
 
+	std::string STBFile(std::string File, bool debug) {
+		// STB = Scyndi Translated Bundle
+		return StripExt(File) + (debug ? ".Debug.STB" : ".STB");
+	}
+
+	std::string SymbolsFile(std::string File) {
+		return StripExt(File) + ".Symbols.STB";
+	}
+
+	// Release profile. Only affects non-debug builds, as debug builds are meant to keep everything.
+	static bool ReleaseProfile{ false };
+	static bool Release(bool debug) { return ReleaseProfile && !debug; }
+
+	std::string InterfaceDigest(GINIE Data) {
+		// #USE only imports the globals and the macros, so nothing else of a dependency can make a rebuild of the dependent needed.
+		if (!Data) return "";
+		std::string ret{ "" };
+		for (auto& G : *Data->List("Globals", "-list-")) ret += "G:" + Upper(G) + "=" + Data->Value("Globals", G) + "\n";
+		for (auto& M : *Data->Values("Macros")) ret += "M:" + M + "=" + Data->Value("Macros", M) + "\n";
+		return md5(ret);
+	}
+
+	struct _BuildState {
+		std::string Source{ "" };
+		std::map<std::string, std::string>
+			RealIncludes{},
+			JCRIncludes{},
+			Dependencies{};
+		std::string Digest(bool debug) {
+			std::string ret{ "Scyndi " + QVersion.Version(true) + "\nDebug=" + boolstring(debug) + "\nDeterministic=" + boolstring(TransDeterministic) + "\nSource=" + Source + "\n" };
+			for (auto& I : RealIncludes) ret += "Include:" + I.first + "=" + I.second + "\n";
+			for (auto& I : JCRIncludes) ret += "JCRInclude:" + I.first + "=" + I.second + "\n";
+			for (auto& D : Dependencies) ret += "Use:" + D.first + "=" + D.second + "\n";
+			return md5(ret);
+		}
+	};
+
+	static void RecordBuild(GINIE D, Slyvina::VecString RealIncludes, Slyvina::VecString JCRIncludes, JT_Dir Res, std::string src, bool debug) {
+		_BuildState B;
+		B.Source = md5(src);
+		for (auto& I : *RealIncludes) B.RealIncludes[I] = FileExists(I) ? md5(FLoadString(I)) : "";
+		for (auto& I : *JCRIncludes) B.JCRIncludes[I] = Res->EntryExists(I) ? md5(Res->GetString(I)) : "";
+		for (auto& U : *D->List("Build", "Dependencies")) B.Dependencies[U] = D->Value("Build::Dependencies", U); // Recorded by TransUse()
+		D->Value("Build", "Compiler", QVersion.Version(true));
+		D->Value("Build", "Debug", boolstring(debug));
+		D->Value("Build", "Release", boolstring(Release(debug)));
+		D->Value("Build", "Deterministic", boolstring(TransDeterministic));
+		D->Value("Build", "Source", B.Source);
+		for (auto& I : B.RealIncludes) { D->AddNew("Build", "RealIncludes", I.first); D->Value("Build::RealIncludes", I.first, I.second); }
+		for (auto& I : B.JCRIncludes) { D->AddNew("Build", "JCRIncludes", I.first); D->Value("Build::JCRIncludes", I.first, I.second); }
+		D->Value("Build", "Interface", InterfaceDigest(D));
+		D->Value("Build", "Digest", B.Digest(debug));
+	}
+
+	// Metadata memo. Only valid during one ProcessProject() run, and kept up to date by Compile() whenever it writes an STB.
+	static std::map<std::string, GINIE> STBConfigs{};
+	static std::map<std::string, Compilation> Verdicts{};
+	static Slyvina::uint64
+		ArchiveOpens{ 0 },
+		OpensAvoided{ 0 },
+		VerdictsReused{ 0 },
+		Translations{ 0 };
+
+	static std::string MemoKey(std::string STB) { return StReplace(STB, "\\", "/"); }
+
+	static void ResetMemo() {
+		STBConfigs.clear();
+		Verdicts.clear();
+		ArchiveOpens = 0;
+		OpensAvoided = 0;
+		VerdictsReused = 0;
+	}
+
+	GINIE STBConfig(std::string STB) {
+		auto Key{ MemoKey(STB) };
+		if (STBConfigs.count(Key)) { OpensAvoided++; return STBConfigs[Key]; }
+		ArchiveOpens++;
+		auto HRes{ JCR6_Dir(STB) };
+		if (!HRes) return nullptr;
+		auto ret{ ParseGINIE(HRes->GetString("Configuration.ini")) };
+		if (ret) STBConfigs[Key] = ret;
+		return ret;
+	}
+
+	bool DependencyInterface(GINIE PrjData, JT_Dir Res, std::string Dep, bool debug, std::string& Interface, bool& fail) {
+		if (Res->EntryExists(Dep + ".Scyndi")) {
+			auto C{ Compile(PrjData, Res, Dep + ".Scyndi", debug, false) };
+			if (C->Result == CompileResult::Fail) { fail = true; return false; }
+			Interface = InterfaceDigest(C->Data);
+			return true;
+		}
+		if (Res->EntryExists(STBFile(Dep + ".Scyndi", debug))) {
+			Interface = InterfaceDigest(STBConfig(Res->Entry(STBFile(Dep + ".Scyndi", debug))->MainFile));
+			return true;
+		}
+		return false;
+	}
+
+	/// <summary>
+	/// Checks the digest recorded in the STB against the current state of the source, its includes and the interfaces of its dependencies.
+	/// Files that have not been touched since the STB was written keep their recorded digest, so only touched files are actually read and hashed.
+	/// </summary>
+	static bool UpToDate(GINIE PrjData, JT_Dir Res, std::string ScyndiSource, std::string OutputFile, GINIE GDat, bool debug, bool& fail) {
+		if (GDat->Value("Build", "Compiler") != QVersion.Version(true)) return false; // Also true for STB files created before digests were recorded
+		if (GDat->Value("Build", "Debug") != boolstring(debug)) return false;
+		if ((Upper(GDat->Value("Build", "Release")) == "TRUE") != Release(debug)) return false;
+		if (Release(debug) && !FileExists(SymbolsFile(OutputFile))) return false;
+		if ((Upper(GDat->Value("Translation", "LineCalls")) == "TRUE") != DebugLineCalls(PrjData, debug)) return false;
+		if (GDat->Value("Translation", "Inline") != std::to_string(InlineBudget(PrjData, debug))) return false;
+		auto Stamp{ FileTimeStamp(OutputFile) };
+		_BuildState B;
+		B.Source = FileTimeStamp(Res->Entry(ScyndiSource)->MainFile) < Stamp ? GDat->Value("Build", "Source") : md5(Res->GetString(ScyndiSource));
+		for (auto& I : *GDat->List("Build", "RealIncludes")) {
+			if (!FileExists(I)) return false;
+			B.RealIncludes[I] = FileTimeStamp(I) < Stamp ? GDat->Value("Build::RealIncludes", I) : md5(FLoadString(I));
+		}
+		for (auto& I : *GDat->List("Build", "JCRIncludes")) {
+			if (!Res->EntryExists(I)) return false;
+			B.JCRIncludes[I] = FileTimeStamp(Res->Entry(I)->MainFile) < Stamp ? GDat->Value("Build::JCRIncludes", I) : md5(Res->GetString(I));
+		}
+		for (auto& D : *GDat->List("Build", "Dependencies")) {
+			if (!DependencyInterface(PrjData, Res, D, debug, B.Dependencies[D], fail)) return false; // Let the translator report the missing dependency
+		}
+		return B.Digest(debug) == GDat->Value("Build", "Digest");
+	}
+
 	bool Modified(std::string File, bool debug, bool force) {
-		if (Done.count(File) && Done[File]) return false; // Even with force, you do not want dupe compilations!
+		if (IsDone(File)) return false; // Even with force, you do not want dupe compilations!
 		if (force) {
 			return true;
 		}
 		auto
-			bcfile{ StripExt(File) + ".stb" }; if (debug) bcfile = StripExt(File) + ".debug.stb";
+			bcfile{ STBFile(File,debug) };
 		if (!FileExists(bcfile)) return true;
-		auto
-			sourcestamp{ FileTimeStamp(File) },
-			compstamp{ FileTimeStamp(bcfile) };
-		auto
-			ret{ (sourcestamp >= compstamp) };
-		//std::cout << "Src: " << sourcestamp << "; Compiled: " << compstamp << ";  modified: " << ret << "\t" << File << "\n";
-		//std::vector < std::string > Dependencies;
-		return ret;
+		if (FileTimeStamp(File) < FileTimeStamp(bcfile)) return false; // Not touched, so no need to check the content.
+		auto GDat{ STBConfig(bcfile) };
+		if (!GDat) return true;
+		return GDat->Value("Build", "Source") != md5(FLoadString(File));
 	}
 
 	bool Modified(JT_Dir JD, std::string file, bool debug, bool Force) {
@@ -124,61 +255,87 @@ namespace Scyndi {
 		return ret;
 	}
 
-	Compilation Compile(GINIE PrjData, Slyvina::JCR6::JT_Dir Res, std::string ScyndiSource, bool debug, bool force) {
+	static Compilation _Compile(GINIE PrjData, Slyvina::JCR6::JT_Dir Res, std::string ScyndiSource, bool debug, bool force) {
 
-		auto OutputFile{ StripExt(Res->Entry(ScyndiSource)->MainFile) + ".STB" };
-		if (debug) OutputFile = StripExt(Res->Entry(ScyndiSource)->MainFile) + ".Debug.STB";
-		if (IsDone(Res->Entry(ScyndiSource)->MainFile)) {
-			auto HRes{ JCR6_Dir(OutputFile) };
-			auto GDat{ ParseGINIE(HRes->GetString("Configuration.ini")) };
-			if (!GDat) {
-				QCol->Error("Error in configuration! Delete " + OutputFile + " and try running Scyndi again");
-				return CReturn(CompileResult::Fail);
-			}
-			return CReturn(CompileResult::Skip, GDat);
+		FileTimer FT{ ScyndiSource };
+		auto OutputFile{ STBFile(Res->Entry(ScyndiSource)->MainFile,debug) };
+		if (!force && FileExists(OutputFile)) {
+			PhaseTimer PT{ "Check" };
+			auto GDat{ STBConfig(OutputFile) };
+			auto Fail{ false };
+			if (GDat && UpToDate(PrjData, Res, ScyndiSource, OutputFile, GDat, debug, Fail)) return CReturn(CompileResult::Skip, GDat);
+			if (Fail) return CReturn(CompileResult::Fail);
 		}
-		if (!force) {
-			auto CanSkip{ true };
-			auto GDat{ ParseGINIE("[NOTHING]\nNothing=Nothing")};
-			//std::cout << OutputFile << " E"<< FileExists(OutputFile)<< " M" << Modified(Res, ScyndiSource, debug, force) << "\n";
-			if (FileExists(OutputFile) && (!Modified(Res,ScyndiSource,debug,force))) {
-				auto HRes{ JCR6_Dir(OutputFile) };
-				GDat = ParseGINIE(HRes->GetString("Configuration.ini"));
-				//QCol->Doing("Unmodified", ScyndiSource); // debug
-				auto Depn{ GDat->List("DEPENDENCIES","List") };
-				//QCol->Doing("Dependencies", Depn->size());
-				if (!Modified(Res, ScyndiSource, debug, force)) {
-					for (auto& D : *Depn) {
-						// QCol->Doing("Checking", D); // debug
-						if (Res->EntryExists(D + ".Scyndi")) {
-							auto C{ Compile(PrjData, Res, D + ".Scyndi", debug, force) };
-							CanSkip = CanSkip && C->Result == CompileResult::Skip;
-							CanSkip = CanSkip && (!IsDone(Res->Entry(D + ".Scyndi")->MainFile));
-							if (C->Result == CompileResult::Fail) return CReturn(CompileResult::Fail);
-						}
-					}
-				}
-			} else { CanSkip = false; }
-			if (CanSkip) return CReturn(CompileResult::Skip, GDat);
-		} //else CanSkip = false;
 
 
 		QCol->Doing("Reading", ScyndiSource);
+		PhaseTimer PTRead{ "Read" };
 		auto src{ Res->GetString(ScyndiSource) };
+		PTRead.Stop();
+		auto Storage{ Ask(PrjData,"Package","Storage","Preferred package storage method:","zlib") };
+		auto MinGain{ Ask(PrjData,"Package","MinGain","Minimal gain (in percent) before an entry gets compressed:","10") };
+		std::string SourceKey{ "" }, CacheKey{ "" };
+		if (BuildCacheEnabled()) {
+			auto Fail{ false };
+			PhaseTimer PT{ "Cache" };
+			BuildCacheFlags Flags;
+			Flags.Debug = debug;
+			Flags.Release = Release(debug);
+			Flags.LineCalls = DebugLineCalls(PrjData, debug);
+			Flags.Storage = Storage;
+			Flags.MinGain = std::atoi(MinGain.c_str());
+			Flags.Inline = InlineBudget(PrjData, debug);
+			SourceKey = BuildCacheSourceKey(ScyndiSource, src, Flags);
+			if (!force) CacheKey = BuildCacheKey(PrjData, Res, SourceKey, BuildCacheRecorded(SourceKey), debug, Fail);
+			if (Fail) return CReturn(CompileResult::Fail);
+			if ((!force) && BuildCacheFetch(CacheKey, OutputFile) && ((!Release(debug)) || BuildCacheFetch(CacheKey + ".Symbols", SymbolsFile(OutputFile)))) {
+				STBConfigs.erase(MemoKey(OutputFile));
+				auto GDat{ STBConfig(OutputFile) };
+				if (GDat) {
+					// The [Build] section is still the one of the checkout that stored the bundle, so it's recorded again against the files here.
+					auto RealIncludes{ Slyvina::NewVecString() }, JCRIncludes{ Slyvina::NewVecString() };
+					*RealIncludes = *GDat->List("Build", "RealIncludes");
+					*JCRIncludes = *GDat->List("Build", "JCRIncludes");
+					RecordBuild(GDat, RealIncludes, JCRIncludes, Res, src, debug);
+					if (ReplaceConfiguration(OutputFile, GDat, Storage, std::atoi(MinGain.c_str()))) {
+						QCol->Doing("Cached", OutputFile);
+						Done[Res->Entry(ScyndiSource)->MainFile] = true;
+						return CReturn(CompileResult::Success, GDat);
+					}
+					STBConfigs.erase(MemoKey(OutputFile)); // Then it's just translated after all
+				}
+			}
+		}
 		auto T{ Translate(src,ScyndiSource,Res,PrjData,debug,force) };
 		if (!T) {
 			QCol->Error(TranslationError());
 			return CReturn(CompileResult::Fail);
 		} else {
 			// QCol->LGreen(T->LuaSource + "\n"); // debug only!
-			auto OutputFile{ StripExt(Res->Entry(ScyndiSource)->MainFile) + ".STB" }; // STB = Scyndi Translated Bundle
-			if (debug) { OutputFile = StripExt(Res->Entry(ScyndiSource)->MainFile) + ".Debug.STB"; }
 			QCol->Doing("Bundling", OutputFile);
-			auto Storage{ Ask(PrjData,"Package","Storage","Preferred package storage method:","zlib") };
+			PhaseTimer PTRecord{ "Check" };
+			RecordBuild(T->Data, T->RealIncludes, T->JCRIncludes, Res, src, debug);
+			PTRecord.Stop();
+			PhaseTimer PTWrite{ "Write" };
 			auto JO{ CreateJCR6(OutputFile) };
-			auto ret{ SaveTranslation(T, JO, Storage,!debug) };
+			JT_Create JS{ nullptr };
+			if (Release(debug)) JS = CreateJCR6(SymbolsFile(OutputFile));
+			else if (FileExists(SymbolsFile(OutputFile))) std::remove(SymbolsFile(OutputFile).c_str()); // Left over from an earlier release build, and no longer matching
+			auto ret{ SaveTranslation(T, JO, Storage,!debug,std::atoi(MinGain.c_str()),JS) };
 			JO->Close();
+			if (JS) JS->Close();
+			PTWrite.Stop();
 			if (!ret) return CReturn(CompileResult::Fail);
+			STBConfigs[MemoKey(OutputFile)] = T->Data;
+			Translations++;
+			if (SourceKey.size()) {
+				// Keyed on what the translator actually included and used, which may differ from what the cache had recorded before
+				auto Fail{ false };
+				CacheKey = BuildCacheKey(PrjData, Res, SourceKey, T->Data, debug, Fail);
+				BuildCacheStore(CacheKey, OutputFile);
+				if (JS && CacheKey.size()) BuildCacheStore(CacheKey + ".Symbols", SymbolsFile(OutputFile));
+				if (CacheKey.size()) BuildCacheRecord(SourceKey, T->Data);
+			}
 			QCol->Doing("Completed", ScyndiSource);
 			std::cout << "\n\n";
 			Done[Res->Entry(ScyndiSource)->MainFile] = true;
@@ -187,44 +344,84 @@ namespace Scyndi {
 
 	}
 
+	Compilation Compile(GINIE PrjData, Slyvina::JCR6::JT_Dir Res, std::string ScyndiSource, bool debug, bool force) {
+		// Every file needs to be judged only once per run. Everything importing it later just gets the verdict.
+		auto Key{ MemoKey(STBFile(Res->Entry(ScyndiSource)->MainFile, debug)) };
+		if (Verdicts.count(Key)) {
+			VerdictsReused++;
+			auto V{ Verdicts[Key] };
+			if (V->Result == CompileResult::Success) return CReturn(CompileResult::Skip, V->Data); // Already done in this run
+			return V;
+		}
+		auto ret{ _Compile(PrjData, Res, ScyndiSource, debug, force) };
+		Verdicts[Key] = ret;
+		return ret;
+	}
 
 
-	Slyvina::uint64 ProcessProject(std::string prj, bool force, bool debug) {
-		Slyvina::uint64
-			Success{ 0 },
-			Skipped{ 0 },
-			Failed{ 0 };
 
-		TransVerbose = true;
+	ProjectModel LoadProject(std::string prj) {
+		ResetMemo();
 		if (!FileExists(prj)) {
 			if (!QuickYes("Project '" + prj + "' does not yet exist. Create it"))
-				return 1;
+				return nullptr;
 			if (!DirectoryExists(ExtractDir(prj))) {
-				if (!QuickYes("Create directory '" + ExtractDir(prj) + "'")) return 1;
+				if (!QuickYes("Create directory '" + ExtractDir(prj) + "'")) return nullptr;
 				MakeDir(ExtractDir(prj));
 			}
 			SaveString(prj,"[Project]\nCreated=" + CurrentDate() + "; " + CurrentTime()+"\n");
 		}
+		auto M{ std::make_shared<_ProjectModel>() };
+		M->File = prj;
 		auto PrjData{ LoadGINIE(prj,prj,"Project file for a Scyndi Project\nLast modified: "+CurrentDate()) };
+		M->PrjData = PrjData;
 		Ask(PrjData, "AA_META", "01_Title", "Project title: ", StripAll(prj));
 		auto author = Ask(PrjData, "AA_META", "02_CreatedBy", "Created by: ");
 		Ask(PrjData, "AA_META", "03_Copyright", "Copyright: ", "(c) " + author);
 		Ask(PrjData, "AA_META", "04_License", "License:");
-		auto Dirs{ AskList(PrjData,"DIRECTORY::" + Slyvina::Platform(),"SOURCEFILES","Name the directories where I can find the source files:") };
-		auto Libs{ AskList(PrjData,"DIRECTORY::" + Slyvina::Platform() ,"Libraries","Name the directories where I can find the libraries:",0) };
+		TransDeterministic = WantDeterministic() || Upper(PrjData->Value("Translation", "Deterministic")) == "TRUE";
+		if (TransDeterministic) QCol->Doing("Output", "Deterministic");
+		ReleaseProfile = WantRelease() || Upper(PrjData->Value("Package", "Profile")) == "RELEASE";
+		if (ReleaseProfile) QCol->Doing("Profile", "Release");
+		InitBuildCache(PrjData);
+		M->Dirs = AskList(PrjData,"DIRECTORY::" + Slyvina::Platform(),"SOURCEFILES","Name the directories where I can find the source files:");
+		M->Libs = AskList(PrjData,"DIRECTORY::" + Slyvina::Platform() ,"Libraries","Name the directories where I can find the libraries:",0);
+		if (!ScanProject(M)) return nullptr;
+		return M;
+	}
+
+	bool ScanProject(ProjectModel M) {
 		auto Res{ std::make_shared<Slyvina::JCR6::_JT_Dir>() };
-		for (auto& D : *Dirs) {
-			if (!DirectoryExists(D)) { QCol->Error("Source directory '" + D + "' does not exist."); return 1; }
+		for (auto& D : *M->Dirs) {
+			if (!DirectoryExists(D)) { QCol->Error("Source directory '" + D + "' does not exist."); return false; }
 			auto DRes{ Slyvina::JCR6::GetDirAsJCR(D,false) };
-			if (!DRes) { QCol->Error("Source directory '" + D + "' could not be analyzed\n" + Last()->ErrorMessage); return 1; }
+			if (!DRes) { QCol->Error("Source directory '" + D + "' could not be analyzed\n" + Last()->ErrorMessage); return false; }
 			Res->Patch(DRes, "Script/");
 		}
-		for (auto& D : *Libs) {
-			if (!DirectoryExists(D)) { QCol->Error("Library directory '" + D + "' does not exist."); return 1; }
+		for (auto& D : *M->Libs) {
+			if (!DirectoryExists(D)) { QCol->Error("Library directory '" + D + "' does not exist."); return false; }
 			auto DRes{ Slyvina::JCR6::GetDirAsJCR(D,false) };
-			if (!DRes) { QCol->Error("Library directory '" + D + "' could not be analyzed\n" + Last()->ErrorMessage); return 1; }
+			if (!DRes) { QCol->Error("Library directory '" + D + "' could not be analyzed\n" + Last()->ErrorMessage); return false; }
 			Res->Patch(DRes, "Libs/");
 		}
+		M->Res = Res;
+		return true;
+	}
+
+	void ForgetVerdict(std::string MainFile, bool debug) {
+		Verdicts.erase(MemoKey(STBFile(MainFile, debug)));
+		Done.erase(MainFile);
+	}
+
+	Slyvina::uint64 TranslationsDone() { return Translations; }
+
+	Slyvina::uint64 BuildProject(ProjectModel M, bool force, bool debug) {
+		Slyvina::uint64
+			Success{ 0 },
+			Skipped{ 0 },
+			Failed{ 0 };
+		auto PrjData{ M->PrjData };
+		auto Res{ M->Res };
 		//auto Storage{ Ask(PrjData,"Package","Storage","Preferred package storage method:","zlib") };
 		auto Entries{ Res->Entries() };
 		//for (auto& E : *Entries) std::cout << "Entry: " << E->Name() << std::endl; // debug only!
@@ -252,6 +449,20 @@ namespace Scyndi {
 		if (Success) QCol->Doing("Success", Success);
 		if (Failed) QCol->Doing("Failed", Failed);
 		if (Skipped) QCol->Doing("Skipped", Skipped);
+		BuildCacheFinish();
+		if ((!Failed) && !LinkProject(M, force, debug)) Failed++;
+		if (OpensAvoided || VerdictsReused) {
+			QCol->Doing("STB opens", ArchiveOpens);
+			QCol->Doing("Opens avoided", OpensAvoided);
+			QCol->Doing("Verdicts reused", VerdictsReused);
+		}
 		return Failed;
 	}
-}
+
+	Slyvina::uint64 ProcessProject(std::string prj, bool force, bool debug) {
+		TransVerbose = true;
+		auto M{ LoadProject(prj) };
+		if (!M) return 1;
+		return BuildProject(M, force, debug);
+	}
+}
\ No newline at end of file
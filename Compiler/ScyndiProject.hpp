@@ -25,8 +25,10 @@
 // EndLic
 #pragma once
 #include <SlyvGINIE.hpp>
+#include <JCR6_Core.hpp>
 #include <string>
 #include <memory>
+#include "Translate.hpp"
 
 namespace Scyndi {
 
@@ -34,8 +36,52 @@ namespace Scyndi {
 	struct _Compilation { CompileResult Result; Slyvina::Units::GINIE Data; };
 	typedef std::shared_ptr<_Compilation> Compilation;
 
+	/// <summary>
+	/// Name of the STB file a Scyndi source file is translated into
+	/// </summary>
+	std::string STBFile(std::string File, bool debug = false);
+	/// <summary>
+	/// Name of the sidecar bundle holding the Lua source and full debug info of a release build (File being the STB file)
+	/// </summary>
+	std::string SymbolsFile(std::string File);
+	/// <summary>
+	/// Digest of everything a #USE request imports from a translation (globals and macros)
+	/// </summary>
+	std::string InterfaceDigest(Slyvina::Units::GINIE Data);
+	/// <summary>
+	/// Parsed Configuration.ini of an STB file. Memoized during a project run, so every bundle is only opened once.
+	/// </summary>
+	Slyvina::Units::GINIE STBConfig(std::string STB);
+	/// <summary>
+	/// Interface digest of a #USE dependency, as recorded by TransUse(). A dependency with its source in the project is compiled first.
+	/// Returns false when the dependency can't be found, and also sets fail when compiling it failed.
+	/// </summary>
+	bool DependencyInterface(Slyvina::Units::GINIE PrjData, Slyvina::JCR6::JT_Dir Res, std::string Dep, bool debug, std::string& Interface, bool& fail);
 	bool Modified(std::string File, bool debug = false, bool force = false);
 	Compilation Compile(Slyvina::Units::GINIE PrjData, Slyvina::JCR6::JT_Dir Res, std::string ScyndiSource, bool debug=false, bool force=false);
 	Slyvina::uint64 ProcessProject(std::string prj, bool force = false, bool debug = false);
 
+	/// <summary>
+	/// Everything known about a project once it's loaded. ProcessProject() throws it away after one build, the watch mode keeps it.
+	/// </summary>
+	struct _ProjectModel {
+		std::string File{ "" };
+		Slyvina::Units::GINIE PrjData{ nullptr };
+		Slyvina::JCR6::JT_Dir Res{ nullptr };
+		Slyvina::VecString
+			Dirs{ nullptr },
+			Libs{ nullptr };
+		Scyndi::TransCache Kept{ nullptr }; // Only set by the watch mode
+	};
+	typedef std::shared_ptr<_ProjectModel> ProjectModel;
+
+	ProjectModel LoadProject(std::string prj);
+	bool ScanProject(ProjectModel M); // (Re)reads the source and library directories
+	Slyvina::uint64 BuildProject(ProjectModel M, bool force = false, bool debug = false);
+	/// <summary>
+	/// Makes the next Compile() of this file judge it again, in stead of returning the verdict of earlier in the run
+	/// </summary>
+	void ForgetVerdict(std::string MainFile, bool debug = false);
+	Slyvina::uint64 TranslationsDone();
+
 }
\ No newline at end of file
@@ -0,0 +1,269 @@
+// License:
+// 
+// Scyndi
+// Compiler timings
+// 
+// 
+// 
+// 	(c) Jeroen P. Broks, 2026
+// 
+// 		This program is free software: you can redistribute it and/or modify
+// 		it under the terms of the GNU General Public License as published by
+// 		the Free Software Foundation, either version 3 of the License, or
+// 		(at your option) any later version.
+// 
+// 		This program is distributed in the hope that it will be useful,
+// 		but WITHOUT ANY WARRANTY; without even the implied warranty of
+// 		MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// 		GNU General Public License for more details.
+// 		You should have received a copy of the GNU General Public License
+// 		along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// 
+// 	Please note that some references to data like pictures or audio, do not automatically
+// 	fall under this licenses. Mostly this is noted in the respective files.
+// 
+// Version: 26.10.19
+// End License
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <vector>
+#include <algorithm>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#include <malloc.h>
+#define AllocSize(p) _msize(p)
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#include <sys/resource.h>
+#define AllocSize(p) malloc_size(p)
+#else
+#include <malloc.h>
+#include <sys/resource.h>
+#define AllocSize(p) malloc_usable_size(p)
+#endif
+
+#include <SlyvQCol.hpp>
+#include <SlyvString.hpp>
+#include <SlyvStream.hpp>
+
+#include "Timings.hpp"
+#include "../ScyndiVersion.hpp"
+
+using namespace Slyvina;
+using namespace Slyvina::Units;
+
+#pragma region "Allocation counting"
+// Replacing the global allocator is the only way to see what the compiler allocates, including everything done in the libraries.
+// Even when not counting, that costs an atomic load and a check on every allocation and every release, so the replacement is only
+// compiled in with ScyndiCountAllocs defined ("scons countallocs=1"). Without it, -timings only has the times and the peak RSS.
+// Counting only happens with -timings. Sizes come from the C runtime, so no bookkeeping is added to the allocations themselves.
+// #define ScyndiCountAllocs
+
+static std::atomic<Slyvina::uint64>
+	AllocCount{ 0 },
+	AllocBytes{ 0 },
+	LiveBytes{ 0 },
+	PeakBytes{ 0 };
+
+#ifdef ScyndiCountAllocs
+static constexpr bool AllocsCounted{ true };
+static std::atomic<bool> CountAllocs{ false };
+
+void* operator new(size_t sz) {
+	auto p{ std::malloc(sz ? sz : 1) };
+	if (!p) throw std::bad_alloc();
+	if (CountAllocs.load(std::memory_order_relaxed)) {
+		auto real{ (Slyvina::uint64)AllocSize(p) };
+		AllocCount++;
+		AllocBytes += real;
+		auto live{ LiveBytes += real };
+		auto peak{ PeakBytes.load() };
+		while (live > peak && !PeakBytes.compare_exchange_weak(peak, live));
+	}
+	return p;
+}
+
+void operator delete(void* p) noexcept {
+	if (!p) return;
+	if (CountAllocs.load(std::memory_order_relaxed)) {
+		// Allocations from before the counting started may be freed now. Never go below zero for those.
+		auto real{ (Slyvina::uint64)AllocSize(p) };
+		auto live{ LiveBytes.load() };
+		while (!LiveBytes.compare_exchange_weak(live, live > real ? live - real : 0));
+	}
+	std::free(p);
+}
+
+void* operator new[](size_t sz) { return operator new(sz); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+#else
+static constexpr bool AllocsCounted{ false };
+#endif
+#pragma endregion
+
+namespace Scyndi {
+
+	typedef std::chrono::steady_clock Clock;
+
+	struct _PhaseStat { double ms{ 0 }; uint64 Allocs{ 0 }, Bytes{ 0 }; };
+	struct _FileStat { std::map<std::string, _PhaseStat> Phases{}; double Total{ 0 }; };
+
+	// Everything running, file timers included. Each frame collects what its children used, so that can be subtracted when it stops.
+	struct _Frame {
+		std::string File, Phase;
+		Clock::time_point Start;
+		uint64 Allocs, Bytes;
+		double ChildMs{ 0 };
+		uint64 ChildAllocs{ 0 }, ChildBytes{ 0 };
+	};
+
+	static bool Enabled{ false };
+	static std::vector<_Frame> Stack{};
+	static std::vector<std::string> Files{};
+	static std::map<std::string, _FileStat> FileStats{};
+	static std::map<std::string, _PhaseStat> Totals{};
+
+	void InitTimings(bool enable) {
+		Enabled = enable;
+#ifdef ScyndiCountAllocs
+		CountAllocs = enable;
+#endif
+		if (enable) QCol->Doing("Timings", AllocsCounted ? "On" : "On (allocations not counted in this build)");
+	}
+
+	bool TimingsEnabled() { return Enabled; }
+
+	static void Push(std::string File, std::string Phase) {
+		Stack.push_back({ File, Phase, Clock::now(), AllocCount.load(), AllocBytes.load() });
+	}
+
+	static void Pop() {
+		auto F{ Stack.back() };
+		Stack.pop_back();
+		auto ms{ std::chrono::duration<double, std::milli>(Clock::now() - F.Start).count() };
+		auto allocs{ AllocCount.load() - F.Allocs };
+		auto bytes{ AllocBytes.load() - F.Bytes };
+		auto& P{ FileStats[F.File].Phases[F.Phase] };
+		P.ms += ms - F.ChildMs;
+		P.Allocs += allocs - F.ChildAllocs;
+		P.Bytes += bytes - F.ChildBytes;
+		auto& T{ Totals[F.Phase] };
+		T.ms += ms - F.ChildMs;
+		T.Allocs += allocs - F.ChildAllocs;
+		T.Bytes += bytes - F.ChildBytes;
+		if (Stack.size()) {
+			Stack.back().ChildMs += ms;
+			Stack.back().ChildAllocs += allocs;
+			Stack.back().ChildBytes += bytes;
+		}
+	}
+
+	PhaseTimer::PhaseTimer(const char* Phase) {
+		if (!(Enabled && Files.size())) return;
+		Push(Files.back(), Phase);
+		Running = true;
+	}
+
+	void PhaseTimer::Stop() {
+		if (!Running) return;
+		Running = false;
+		Pop();
+	}
+
+	FileTimer::FileTimer(std::string File) {
+		if (!Enabled) return;
+		Files.push_back(File);
+		Push(File, "Other"); // Whatever none of the phase timers covers
+		Running = true;
+	}
+
+	FileTimer::~FileTimer() {
+		if (!Running) return;
+		Pop();
+		Files.pop_back();
+	}
+
+	static uint64 PeakRSS() {
+#if defined(_WIN32)
+		PROCESS_MEMORY_COUNTERS pmc;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return (uint64)pmc.PeakWorkingSetSize;
+		return 0;
+#else
+		struct rusage ru;
+		if (getrusage(RUSAGE_SELF, &ru)) return 0;
+#if defined(__APPLE__)
+		return (uint64)ru.ru_maxrss; // Bytes on Mac
+#else
+		return (uint64)ru.ru_maxrss * 1024; // KB on Linux
+#endif
+#endif
+	}
+
+	static std::string JSONString(std::string s) {
+		std::string ret{ "\"" };
+		for (auto ch : s) {
+			switch (ch) {
+			case '"': ret += "\\\""; break;
+			case '\\': ret += "\\\\"; break;
+			case '\n': ret += "\\n"; break;
+			case '\t': ret += "\\t"; break;
+			default: if ((unsigned char)ch < 32) ret += TrSPrintF("\\u%04x", ch); else ret += ch;
+			}
+		}
+		return ret + "\"";
+	}
+
+	static std::string JSONPhases(std::map<std::string, _PhaseStat>& Phases, std::string Indent) {
+		std::string ret{ "{" };
+		bool first{ true };
+		for (auto& P : Phases) {
+			ret += (first ? "\n" : ",\n") + Indent + "\t" + JSONString(P.first) + TrSPrintF(": { \"ms\": %.3f, \"allocations\": %llu, \"bytes\": %llu }", P.second.ms, (unsigned long long)P.second.Allocs, (unsigned long long)P.second.Bytes);
+			first = false;
+		}
+		return ret + "\n" + Indent + "}";
+	}
+
+	void TimingsReport(std::string JSONFile, int TopN) {
+		if (!Enabled) return;
+		std::vector<std::pair<std::string, double>> Slowest{};
+		for (auto& F : FileStats) {
+			F.second.Total = 0;
+			for (auto& P : F.second.Phases) F.second.Total += P.second.ms;
+			Slowest.push_back({ F.first, F.second.Total });
+		}
+		std::sort(Slowest.begin(), Slowest.end(), [](const std::pair<std::string, double>& a, const std::pair<std::string, double>& b) { return a.second > b.second; });
+		double Total{ 0 };
+		for (auto& P : Totals) Total += P.second.ms;
+		std::string J{ "{\n" };
+		J += "\t\"compiler\": " + JSONString("Scyndi " + QVersion.Version(true)) + ",\n";
+		J += TrSPrintF("\t\"total_ms\": %.3f,\n", Total);
+		J += TrSPrintF("\t\"allocations_counted\": %s,\n", AllocsCounted ? "true" : "false");
+		J += TrSPrintF("\t\"allocations\": %llu,\n", (unsigned long long)AllocCount.load());
+		J += TrSPrintF("\t\"allocated_bytes\": %llu,\n", (unsigned long long)AllocBytes.load());
+		J += TrSPrintF("\t\"peak_heap_bytes\": %llu,\n", (unsigned long long)PeakBytes.load());
+		J += TrSPrintF("\t\"peak_rss_bytes\": %llu,\n", (unsigned long long)PeakRSS());
+		J += "\t\"phases\": " + JSONPhases(Totals, "\t") + ",\n";
+		J += "\t\"files\": [";
+		for (size_t i = 0; i < Slowest.size(); i++) {
+			auto& F{ FileStats[Slowest[i].first] };
+			J += i ? ",\n" : "\n";
+			J += "\t\t{ \"file\": " + JSONString(Slowest[i].first) + TrSPrintF(", \"ms\": %.3f, \"phases\": ", F.Total) + JSONPhases(F.Phases, "\t\t") + " }";
+		}
+		J += "\n\t]\n}\n";
+		SaveString(JSONFile, J);
+		QCol->Doing("Timings", JSONFile);
+		for (auto& P : Totals) QCol->Doing(P.first, TrSPrintF("%10.2f ms; %8llu allocations", P.second.ms, (unsigned long long)P.second.Allocs));
+		if (AllocsCounted) QCol->Doing("Peak heap", TrSPrintF("%.1f MB", PeakBytes.load() / (1024.0 * 1024.0)));
+		QCol->Doing("Peak RSS", TrSPrintF("%.1f MB", PeakRSS() / (1024.0 * 1024.0)));
+		QCol->LGreen(TrSPrintF("Slowest %d files\n", TopN));
+		for (int i = 0; i < TopN && i < (int)Slowest.size(); i++) QCol->Doing(TrSPrintF("%10.2f ms", Slowest[i].second), Slowest[i].first);
+	}
+}
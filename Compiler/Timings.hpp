@@ -0,0 +1,68 @@
+// License:
+// 
+// Scyndi
+// Compiler timings (header)
+// 
+// 
+// 
+// 	(c) Jeroen P. Broks, 2026
+// 
+// 		This program is free software: you can redistribute it and/or modify
+// 		it under the terms of the GNU General Public License as published by
+// 		the Free Software Foundation, either version 3 of the License, or
+// 		(at your option) any later version.
+// 
+// 		This program is distributed in the hope that it will be useful,
+// 		but WITHOUT ANY WARRANTY; without even the implied warranty of
+// 		MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// 		GNU General Public License for more details.
+// 		You should have received a copy of the GNU General Public License
+// 		along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// 
+// 	Please note that some references to data like pictures or audio, do not automatically
+// 	fall under this licenses. Mostly this is noted in the respective files.
+// 
+// Version: 26.10.19
+// End License
+
+#pragma once
+#include <string>
+#include <Slyvina.hpp>
+
+namespace Scyndi {
+
+	/// <summary>
+	/// Turns the recording on (-timings). When off, all timers below cost next to nothing.
+	/// </summary>
+	void InitTimings(bool enable);
+	bool TimingsEnabled();
+
+	/// <summary>
+	/// Measures the time and the allocations from its creation until Stop() (or destruction), and books them on a phase of the file being compiled.
+	/// Timers running within this one (dependencies being compiled in the middle of it) are subtracted, so no time is ever counted twice.
+	/// </summary>
+	class PhaseTimer {
+	private:
+		bool Running{ false };
+	public:
+		PhaseTimer(const char* Phase);
+		void Stop();
+		~PhaseTimer() { Stop(); }
+	};
+
+	/// <summary>
+	/// Marks the compilation of a file. Phase timers created in the meantime are booked on this file.
+	/// </summary>
+	class FileTimer {
+	private:
+		bool Running{ false };
+	public:
+		FileTimer(std::string File);
+		~FileTimer();
+	};
+
+	/// <summary>
+	/// Writes the JSON report and shows the TopN slowest files
+	/// </summary>
+	void TimingsReport(std::string JSONFile, int TopN = 10);
+}
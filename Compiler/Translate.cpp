@@ -38,6 +38,7 @@
 #include "ScyndiGlobals.hpp"
 #include "Keywords.hpp"
 #include "ScyndiProject.hpp"
+#include "Timings.hpp"
 
 #undef TransDebug
 #undef TransVeryVerbose
@@ -57,7 +58,7 @@
 #define Chat(abc)
 #endif
 
-#define DbgLineCheck if (debug && (!Ins->ScopeData->DidReturn)) *Trans += TrSPrintF("Scyndi.Debug.Line(Scyndi.Debug.StateName,\"%s\",%d)\t",srcfile.c_str(),Ins->LineNumber)
+#define DbgLineCheck if (LineCalls && (!Ins->ScopeData->DidReturn)) *Trans += TrSPrintF("Scyndi.Debug.Line(Scyndi.Debug.StateName,\"%s\",%d)\t",Ins->SourceFile.c_str(),Ins->LineNumber)
 
 using namespace Slyvina;
 using namespace Slyvina::Units;
@@ -65,6 +66,8 @@ using namespace Slyvina::Units;
 namespace Scyndi {
 
 	bool TransVerbose{ false };
+	bool TransDeterministic{ false };
+	TransCache TransKept{ nullptr };
 
 	enum class InsKind {
 		Unknown, HeaderDefintion, General,
@@ -83,7 +86,8 @@ namespace Scyndi {
 		ExternImport,
 		QFuncDef,
 		DefTable,DefTableIndex,
-		Break
+		Break,
+		StartRecord,RecordField
 	};
 	enum class WordKind {
 		Unknown, String, Number,
@@ -100,12 +104,12 @@ namespace Scyndi {
 		ElseScope, Declaration, WhileScope,
 		Switch, Case, Default,
 		FunctionBody, Defer , Do,
-		QFuncBody,DefTable
+		QFuncBody,DefTable,Record
 	};
 
 	enum class VarType { Unknown, Integer, String, Table, Number, Boolean, CustomClass, pLua, Byte, UserData, Delegate, Void, Var };
 
-	struct Arg { std::string Name{ "" }, ref{ "" }, BaseValue{ "" }; VarType dType{ VarType::Unknown }; bool HasBaseValue{ false }; };
+	struct Arg { std::string Name{ "" }, ref{ "" }, BaseValue{ "" }; VarType dType{ VarType::Unknown }; bool HasBaseValue{ false }; std::string Record{ "" }; };
 
 	class _Declaration {
 	public:
@@ -121,7 +125,8 @@ namespace Scyndi {
 			IsConstant{ false };
 		std::string
 			CustomClass{ "" },
-			BoundToClass{ "" };
+			BoundToClass{ "" },
+			Record{ "" }; // Set when the type is a RECORD. Type is then Table.
 
 		static std::string E2S(VarType T) {
 			for (auto& K : S2E) if (K.second == T) return K.first;
@@ -244,6 +249,25 @@ namespace Scyndi {
 	typedef std::shared_ptr<_Instruction> Instruction;
 
 
+	// RECORD: A fixed list of typed fields. Only the translator knows about records. In Lua they are plain tables with the upper case field names.
+	// Field names are only put in upper case where the translator knows it's dealing with a record: variables, parameters and members typed as one, and their record fields.
+	// Through anything else (VAR or PLUA variables, function results, table elements) a field must be written in upper case, as ".x" then just reads the Lua field "x", which is nil.
+	struct _RecordField {
+		std::string Name{ "" }, TypeName{ "" };
+		VarType Type{ VarType::Unknown };
+		std::string Record{ "" }; // Set when the field is a record itself
+		std::string Value{ "" }; // Default value (Lua code)
+	};
+	struct _RecordDef {
+		std::string Name{ "" };
+		std::vector<_RecordField> Fields{};
+		_RecordField* Field(std::string Name) {
+			for (auto& F : Fields) if (F.Name == Name) return &F;
+			return nullptr;
+		}
+	};
+	typedef std::shared_ptr<_RecordDef> RecordDef;
+
 class _Scope {
 public:
 	bool DidReturn{ false }; // Needed to make sure that nothing could be placed after the return command (Lua doesn't accept that).
@@ -258,9 +282,41 @@ public:
 	size_t caseCount{ 0 }; // Only for the translation itself so the labels can be created properly.
 	_Scope* Parent{ nullptr };
 	Declaration DecData{ nullptr };
-	std::string DeferID{ "" };
+	std::vector<std::string> Defers{}; // Translated DEFER blocks of a function, in the order they appear.
 	std::string ClassID{ "" };
 	String TableDefVar{ "" };
+	std::map<std::string, RecordDef> Records{}; // Only filled in the root scope
+	std::map<std::string, std::string> RecordVars{}; // Variable => Record
+	std::map<std::string, std::string> MemberRecords{}; // Instance member => Record. Only in methods and properties, for SELF.<member>
+	RecordDef RecordData{ nullptr }; // The record a record scope defines
+
+	// DDEF quick functions which are only a RETURN, by their Lua name. Calls to these get the expression itself, with the arguments in place of the "...".
+	// Root and static functions which are only a RETURN have Pieces in stead: text, each followed by the argument of that parameter (or none for npos).
+	// Ordered when every parameter is in there exactly once, in the order of the parameters. Only then the arguments are evaluated just like with a call.
+	struct QuickInline { std::string Pre{ "" }, Post{ "" }; bool Comma{ false }, Wrap{ false }, Ordered{ false }; size_t Params{ 0 }; std::vector<std::pair<std::string, size_t>> Pieces{}; };
+	std::map<std::string, QuickInline> Inlines{};
+	QuickInline* Inline(std::string LuaName) {
+		for (auto fscope = this; fscope; fscope = fscope->Parent) if (fscope->Inlines.count(LuaName)) return &fscope->Inlines[LuaName];
+		return nullptr;
+	}
+
+	RecordDef Record(std::string Name) {
+		for (auto fscope = this; fscope; fscope = fscope->Parent) if (fscope->Records.count(Name)) return fscope->Records[Name];
+		return nullptr;
+	}
+
+	std::string RecordVar(std::string _id) {
+		for (auto fscope = this; fscope; fscope = fscope->Parent) {
+			if (fscope->RecordVars.count(_id)) return fscope->RecordVars[_id];
+			if (fscope->LocalVars->count(_id)) return ""; // Overshadowed by a local which is not a record
+		}
+		return "";
+	}
+
+	std::string MemberRecord(std::string Member) {
+		for (auto fscope = this; fscope; fscope = fscope->Parent) if (fscope->MemberRecords.count(Member)) return fscope->MemberRecords[Member];
+		return "";
+	}
 
 	_Scope* DecScope() {
 		if (Kind == ScopeKind::Declaration) return Parent; else return this;
@@ -346,14 +402,18 @@ public:
 		auto Check{ this };
 		do {
 			switch (Check->Kind) {
+			case ScopeKind::QFuncBody:
+				return ""; // A function of its own, which can't have any DEFERs
 			case ScopeKind::Init:
 			case ScopeKind::FunctionBody:
 			case ScopeKind::Method:
-			//case ScopeKind::QFuncBody:
-				if (DeferID.size())
-					return "for _,ifunc in ipairs(" + DeferID + ") do ifunc() end;\t";
-				else
-					return "";
+			{
+				// DEFER blocks can only be put directly in a function body, so at any exit all DEFERs before it have been passed.
+				// Therefore they can just be put in here, last one first.
+				std::string Ret{ "" };
+				for (auto i = Check->Defers.size(); i > 0; --i) Ret += "do\n" + Check->Defers[i - 1] + "end\t";
+				return Ret;
+			}
 			default:
 				Check = Check->Parent;
 				if (!Check) {
@@ -368,13 +428,42 @@ public:
 };
 
 
+	// One per class this translation adds anything to. Written out as one table, which Scyndi.RegisterClasses installs in one go with the others.
+	struct _ClassDesc {
+		std::string Name{ "" }; // Upper case
+		std::string Local{ "" };
+		std::string Extends{ "" };
+		bool Start{ false }, Pooled{ false };
+		std::vector<std::pair<Instruction, std::string>> Members{};
+		std::map<std::string, std::string> Names{}; // Member name => what it is. For the dupe checks.
+	};
+
 	class _TransProcess {
 	public:
 		//_Scope RootScope{};
+		std::map<std::string, _ClassDesc> ClassDescs{};
+		std::vector<std::string> ClassDescOrder{};
+		std::map<std::string, bool> PooledClasses{};
+		_ClassDesc* ClassDesc(std::string Class) {
+			auto CU{ Upper(Class) };
+			if (!ClassDescs.count(CU)) return nullptr;
+			return &ClassDescs[CU];
+		}
 		std::vector < Instruction > Instructions;
 		Translation Trans{};
 		std::vector<Scope> Scopes;
 		std::map<std::string, std::vector<std::string>> Fields{};
+		std::map<std::string, std::map<std::string, std::string>> RecordFields{}; // Class => Instance member => Record
+		// Methods and properties know the instance members as "self.<member>" locals, and the record members among them as records.
+		void MapFields(Scope S, std::string Class) {
+			auto CU{ Upper(Class) };
+			for (auto& FLD : Fields[CU]) {
+				(*S->LocalVars)[FLD] = "self." + FLD;
+				S->RecordVars.erase(FLD);
+			}
+			for (auto& RF : RecordFields[CU]) S->RecordVars[RF.first] = RF.second;
+			S->MemberRecords = RecordFields[CU];
+		}
 		std::map<std::string, Property> RootProperties{};
 		std::map<std::string, std::map<std::string, Property>> ClassProperty{};
 		Scope RootScope;
@@ -398,6 +487,12 @@ public:
 			return Scopes[lvl - 1];
 		}
 		ScopeKind ScopeK() { return GetScope()->Kind; }
+
+		// Counters for generated names. These live per translation, so the names do not depend on what was translated before.
+		std::map<std::string, size_t> Counters{};
+		size_t Count(std::string Tag) { return Counters[Tag]++; }
+		std::map<std::string, size_t> CaseCount{};
+
 		_TransProcess() {
 			RootScope = std::make_shared<_Scope>();
 			RootScope->Kind = ScopeKind::Root;
@@ -869,23 +964,162 @@ public:
 		return "WK" + std::to_string((int)K);
 	}
 
+	// Records are plain tables, so there's no check at runtime at all. Literals must therefore match the field type exactly.
+	static std::string RecordLiteralError(std::string Record, const _RecordField& F, Word Lit) {
+		std::string Got{ "" };
+		if (Lit->Kind == WordKind::String) Got = "a string";
+		else if (Lit->Kind == WordKind::Number) Got = "a number";
+		else if (Lit->UpWord == "TRUE" || Lit->UpWord == "FALSE") Got = "a boolean";
+		else if (Lit->UpWord == "NIL") Got = "nil";
+		else return ""; // No literal, so nothing to check
+		bool Ok{ false };
+		if (F.Record.size()) Ok = Got == "nil";
+		else switch (F.Type) {
+		case VarType::Byte:
+		case VarType::Integer:
+			Ok = Got == "a number" && Lit->TheWord.find('.') == std::string::npos;
+			if (Ok && F.Type == VarType::Byte && Lit->TheWord.find_first_not_of("0123456789") == std::string::npos) Ok = Lit->TheWord.size() < 4 && std::stoi(Lit->TheWord) < 256;
+			break;
+		case VarType::Number: Ok = Got == "a number"; break;
+		case VarType::String: Ok = Got == "a string"; break;
+		case VarType::Boolean: Ok = Got == "a boolean"; break;
+		case VarType::Table:
+		case VarType::Delegate: Ok = Got == "nil"; break;
+		default: Ok = true; break;
+		}
+		if (Ok) return "";
+		return TrSPrintF("Field %s of record %s is %s, but got %s (%s)", F.Name.c_str(), Record.c_str(), F.TypeName.c_str(), Got.c_str(), Lit->TheWord.c_str());
+	}
+
+	static std::string RecordValue(RecordDef R) {
+		std::string Ret{ "{" };
+		for (size_t i = 0; i < R->Fields.size(); i++) {
+			if (i) Ret += ", ";
+			Ret += R->Fields[i].Name + "=" + R->Fields[i].Value;
+		}
+		return Ret + "}";
+	}
+
 	static std::shared_ptr<std::string> Expression(Translation T,Instruction Ins, size_t start,bool ignoreglobals=false) {
 		std::string Ret{ "" };
 		auto srcfile{ Ins->SourceFile };
 		auto LineNumber{ Ins->LineNumber };
 		auto kw_new{ 0u };
+		// Records: Fields are checked and put in upper case, and NEW Record(...) becomes a table constructor.
+		struct RecNew { RecordDef Def; size_t Depth; size_t Arg; };
+		std::vector<RecNew> RecNews{};
+		RecordDef NewRec{ nullptr };
+		size_t Depth{ 0 };
+		std::string Rec{ "" }; // Record of what has just been put out, if known.
+		bool Self{ false }; // SELF has just been put out
+		_RecordField* RecField{ nullptr }; // Record field which has just been put out.
+		std::string RecFieldOf{ "" };
+		auto RecArg{ [&](size_t p)->std::string {
+			auto& RN{ RecNews.back() };
+			if (RN.Arg >= RN.Def->Fields.size()) return "Too many values for record " + RN.Def->Name;
+			if (p + 1 < Ins->Words.size() && (Ins->Words[p + 1]->Kind == WordKind::Comma || Ins->Words[p + 1]->Kind == WordKind::HaakjeSluiten)) {
+				auto Err{ RecordLiteralError(RN.Def->Name, RN.Def->Fields[RN.Arg], Ins->Words[p]) };
+				if (Err.size()) return Err;
+			}
+			Ret += RN.Def->Fields[RN.Arg].Name + "=";
+			return "";
+		} };
+		// Inlined calls: Returns where the call that opens at Open closes, or 0 when it's not to be inlined.
+		// Arguments with calls in them are left alone, as their side effects could otherwise take place after those of the inlined function.
+		// Same for fields and indexes, as those can be properties with a getter behind them.
+		auto PureCall{ [&](size_t Open)->size_t {
+			size_t D{ 0 };
+			for (auto Close = Open; Close < Ins->Words.size(); Close++) {
+				auto CW{ Ins->Words[Close] };
+				if (CW->UpWord == "NEW" || CW->Kind == WordKind::Field || (Close > Open && CW->TheWord == "[")) return 0;
+				if (CW->Kind == WordKind::HaakjeOpenen) {
+					auto PW{ Ins->Words[Close - 1] };
+					if (Close > Open && (PW->Kind == WordKind::Identifier || PW->Kind == WordKind::Field || PW->Kind == WordKind::HaakjeSluiten)) return 0;
+					D++;
+				} else if (CW->Kind == WordKind::HaakjeSluiten && !--D) return Close;
+			}
+			return 0;
+		} };
+		auto SubExpression{ [&](size_t From, size_t To) {
+			auto AI{ std::make_shared<_Instruction>(*Ins) };
+			AI->Words = std::vector<Word>(Ins->Words.begin() + From, Ins->Words.begin() + To);
+			return Expression(T, AI, 0, ignoreglobals);
+		} };
+		// The expression in stead of the call. nullptr on errors, and an empty string when the call is to stay.
+		auto InlineCall{ [&](_Scope::QuickInline* QI, size_t Open, size_t Close)->std::shared_ptr<std::string> {
+			auto Out{ std::make_shared<std::string>("") };
+			// A statement can't be just an expression
+			auto Whole{ Open == start + 1 || (Open == start + 2 && Ins->Words[start + 1]->Kind == WordKind::Field) };
+			if ((QI->Wrap || QI->Pieces.size()) && Ins->Kind == InsKind::General && Whole && Close + 1 == Ins->Words.size()) return Out;
+			if (QI->Pieces.size()) {
+				// Otherwise arguments may be evaluated more than once, in another order, or not at all. Which only literals and plain locals can take.
+				auto Simple{ [&](size_t From, size_t To) {
+					if (To != From + 1) return false;
+					auto AW{ Ins->Words[From] };
+					if (AW->Kind == WordKind::Number || AW->Kind == WordKind::String || AW->UpWord == "TRUE" || AW->UpWord == "FALSE" || AW->UpWord == "NIL") return true;
+					if (AW->Kind != WordKind::Identifier) return false;
+					auto Local{ Ins->ScopeData->Identifier(T, Ins->LineNumber, AW->UpWord, true) };
+					return Local.size() && !Prefixed(Local, "self."); // Members of an instance go through its metatable
+				} };
+				std::vector<std::string> Args{};
+				size_t D{ 0 }, From{ Open + 1 };
+				for (auto i = Open + 1; i <= Close; i++) {
+					auto CW{ Ins->Words[i] };
+					if (CW->Kind == WordKind::HaakjeOpenen) D++;
+					else if (CW->Kind == WordKind::HaakjeSluiten && D) D--;
+					else if ((CW->Kind == WordKind::Comma && !D) || (i == Close && Close > Open + 1)) {
+						if (!(QI->Ordered || Simple(From, i))) return Out;
+						auto AEx{ SubExpression(From, i) };
+						if (!AEx) return nullptr;
+						Args.push_back(*AEx);
+						From = i + 1;
+					}
+				}
+				if (Args.size() > QI->Params) return Out;
+				for (auto& P : QI->Pieces) {
+					*Out += P.first;
+					// The function itself gets "Arg or nil" for an untyped parameter, so false becomes nil in there as well
+					if (P.second < Args.size()) *Out += "(" + Args[P.second] + " or nil)"; else if (P.second != std::string::npos) *Out += "nil";
+				}
+			} else {
+				std::string Args{ "" };
+				if (Close > Open + 1) {
+					auto AEx{ SubExpression(Open + 1, Close) };
+					if (!AEx) return nullptr;
+					Args = *AEx;
+				}
+				auto Pre{ QI->Pre };
+				if (!Args.size() && QI->Comma) Pre = Pre.substr(0, Pre.find_last_of(','));
+				*Out = Pre + Args + QI->Post;
+			}
+			if (QI->Wrap) *Out = "(" + *Out + ")";
+			return Out;
+		} };
+		std::string Id{ "" }; // Lua name of the identifier which has just been put out
+		size_t IdAt{ 0 };
 		for (size_t pos = start; pos < Ins->Words.size(); pos++) {
 			if (Ret.size()) Ret += " ";
 			auto W{ Ins->Words[pos] };
+			auto WasId{ Id }; Id = "";
+			auto WasRec{ Rec }; Rec = "";
+			auto WasSelf{ Self }; Self = false;
+			auto WasField{ RecField }; RecField = nullptr;
 			switch (kw_new) {
 			case 2:
 				TransAssert(W->Kind == WordKind::Identifier, "NEW syntax error");
-				Ret += TrSPrintF("Scyndi.New(\"%s\" ", W->UpWord.c_str());
+				NewRec = Ins->ScopeData->Record(W->UpWord);
+				if (!NewRec) Ret += TrSPrintF("Scyndi.New(\"%s\" ", W->UpWord.c_str());
 				kw_new--;
 				break;
 			case 1:
 				TransAssert(W->TheWord == "(","( expected for constructor parameters");
-				if (pos + 1 < Ins->Words.size() && Ins->Words[pos + 1]->UpWord != ")") Ret += ",";
+				Depth++;
+				if (NewRec) {
+					Ret += "{";
+					RecNews.push_back({ NewRec, Depth, 0 });
+					NewRec = nullptr;
+					if (pos + 1 < Ins->Words.size() && Ins->Words[pos + 1]->UpWord != ")") { auto Err{ RecArg(pos + 1) }; TransAssert(!Err.size(), Err); }
+				} else if (pos + 1 < Ins->Words.size() && Ins->Words[pos + 1]->UpWord != ")") Ret += ",";
 				kw_new--;
 				break;
 			default:
@@ -894,23 +1128,97 @@ public:
 					auto WT{ Ins->ScopeData->Identifier(T,Ins->LineNumber,W->UpWord,ignoreglobals) };
 					//if (!WT.size()) for (size_t pos = start; pos < Ins->Words.size(); pos++) { std::cout << "Word #" << pos << ": " << Ins->Words[pos]->TheWord << "\n"; } // debug only
 					TransAssert(WT.size(), "Unknown identifier " + W->TheWord);
+					auto QI{ Ins->ScopeData->Inline(WT) };
+					if (QI && pos + 1 < Ins->Words.size() && Ins->Words[pos + 1]->Kind == WordKind::HaakjeOpenen) {
+						auto Close{ PureCall(pos + 1) };
+						if (Close) {
+							auto In{ InlineCall(QI, pos + 1, Close) };
+							if (!In) return nullptr;
+							if (In->size()) {
+								Ret += *In;
+								pos = Close;
+								break;
+							}
+						}
+					}
+					IdAt = Ret.size();
+					Id = WT;
 					Ret += WT;
+					Rec = Ins->ScopeData->RecordVar(W->UpWord);
+					Self = W->UpWord == "SELF";
 				} break;
 				case WordKind::HaakjeOpenen:
-				case WordKind::HaakjeSluiten:
+					Depth++;
 					Ret += W->TheWord;
 					break;
+				case WordKind::HaakjeSluiten:
+					if (RecNews.size() && RecNews.back().Depth == Depth) {
+						auto& RN{ RecNews.back() };
+						// Fields not given get their default value
+						auto Given{ Ins->Words[pos - 1]->Kind == WordKind::HaakjeOpenen ? 0 : RN.Arg + 1 };
+						for (auto i = Given; i < RN.Def->Fields.size(); i++) {
+							if (i) Ret += ", ";
+							Ret += RN.Def->Fields[i].Name + "=" + RN.Def->Fields[i].Value;
+						}
+						Ret += "}";
+						Rec = RN.Def->Name;
+						RecNews.pop_back();
+					} else
+						Ret += W->TheWord;
+					if (Depth) Depth--;
+					break;
 				case WordKind::String:
 					Ret += '"';
 					Ret += W->TheWord;
 					Ret += '"';
 					break;
 				case WordKind::Field:
+					if (WasRec.size()) {
+						auto RD{ Ins->ScopeData->Record(WasRec) };
+						TransAssert(RD, "Record " + WasRec + " unknown (Internal error! Please report!)");
+						RecField = RD->Field(Upper(W->TheWord.substr(1)));
+						TransAssert(RecField, "Record " + RD->Name + " has no field " + W->TheWord.substr(1));
+						RecFieldOf = RD->Name;
+						Ret += "." + RecField->Name;
+						Rec = RecField->Record;
+					} else if (WasSelf && Ins->ScopeData->MemberRecord(Upper(W->TheWord.substr(1))).size()) {
+						Ret += "." + Upper(W->TheWord.substr(1));
+						Rec = Ins->ScopeData->MemberRecord(Upper(W->TheWord.substr(1)));
+					} else {
+						// Class.Function(...) with an inlined static function
+						auto QI{ WasId.size() ? Ins->ScopeData->Inline(WasId + "." + Upper(W->TheWord.substr(1))) : nullptr };
+						if (QI && pos + 1 < Ins->Words.size() && Ins->Words[pos + 1]->Kind == WordKind::HaakjeOpenen) {
+							auto Close{ PureCall(pos + 1) };
+							if (Close) {
+								auto In{ InlineCall(QI, pos + 1, Close) };
+								if (!In) return nullptr;
+								if (In->size()) {
+									Ret.resize(IdAt);
+									Ret += *In;
+									pos = Close;
+									break;
+								}
+							}
+						}
+						Ret += W->TheWord;
+					}
+					break;
+				case WordKind::Comma:
+					if (RecNews.size() && RecNews.back().Depth == Depth) {
+						Ret += ",";
+						RecNews.back().Arg++;
+						TransAssert(pos + 1 < Ins->Words.size(), "Value expected after comma");
+						auto Err{ RecArg(pos + 1) }; TransAssert(!Err.size(), Err);
+						break;
+					}
 					Ret += W->TheWord;
 					break;
 				case WordKind::Number:
-				case WordKind::Comma:
 				case WordKind::Operator:
+					if (WasField && W->TheWord == "=" && pos + 2 == Ins->Words.size()) {
+						auto Err{ RecordLiteralError(RecFieldOf, *WasField, Ins->Words[pos + 1]) };
+						TransAssert(!Err.size(), Err);
+					}
 					if (W->TheWord == "!")
 						Ret += " not ";
 					else if (W->TheWord == "!=")
@@ -943,7 +1251,7 @@ public:
 		}
 		switch (kw_new) {
 		case 2: TransError("Class expected after NEW");
-		case 1: Ret += ")"; break;
+		case 1: if (NewRec) Ret += RecordValue(NewRec); else Ret += ")"; break;
 		case 0: break;
 		default: TransError(TrSPrintF("Internal error! (kw_new=%d) Please report!", kw_new));
 		}
@@ -955,6 +1263,7 @@ public:
 		auto bcFile{ Para }; if (debug) bcFile += ".debug"; bcFile += ".stb";
 		auto srFile{ Para };
 		auto skip{ false };
+		std::string Interface{ "" };
 		//VecString GetMacros{ nullptr };
 		if (JD->EntryExists(Para + ".Scyndi")) {
 			srFile += ".Scyndi";
@@ -973,8 +1282,7 @@ public:
 			return true;
 		} else BoolError("No way found to get any data about #USE request for " + Para);
 		if (skip) {
-			auto bcj{ JCR6::JCR6_Dir(JD->Entry(bcFile)->MainFile) };
-			auto g{ ParseGINIE(bcj->GetString("Configuration.ini")) };
+			auto g{ STBConfig(JD->Entry(bcFile)->MainFile) };
 			BoolAssert(g, "Parsing GINIE failed! Delete the STB file and try again! ");
 			BoolAssert(Upper(g->Value("Translation", "Target")) == "LUA", "Target error");
 			BoolAssert(g->Value("Lua", "Version") == Slyvina::NSLunatic::_Lunatic::LuaVersion(), TrSPrintF("This translation is for Lua version %s. However this version of Scyndi works with Lua version %s", g->Value("Lua", "Version").c_str(), NSLunatic::_Lunatic::LuaVersion().c_str()));
@@ -989,15 +1297,23 @@ public:
 				//QCol->Doing("-> Macro " + M, g->Value("Macros", M)); // DEBUG ONLY!!
 				(*Macros)[M] = g->Value("Macros", M);
 			}
+			Interface = InterfaceDigest(g);
+		} else if (TransKept && TransKept->Imports.count(Upper(srFile))) {
+			auto& I{ TransKept->Imports[Upper(srFile)] };
+			for (auto& G : I->Globals) (*Ret->Trans->GlobalVar)[G.first] = G.second;
+			for (auto& M : I->Macros) (*Macros)[M.first] = M.second;
+			Interface = I->Interface;
 		} else {
 			auto CR{ Compile(dat,JD,srFile,debug,force) };
 			BoolAssert(CR, "Compilation returned NULL (internal error. Please report!)");
 			BoolAssert(CR->Result != CompileResult::Fail, TrSPrintF("#USE request for '%s' failed", Para.c_str()));
 			if (CR->Result == CompileResult::Skip) {
 				Verb("Status", "Up-to-date");
-				auto ent{ JD->Entry(bcFile) }; BoolAssert(ent, "JCR6 failed to get data for '" + bcFile + "'  (" + JCR6::Last()->ErrorMessage + ")");
-				auto bcj{ JCR6::JCR6_Dir(ent->MainFile) };
-				CR->Data = ParseGINIE(bcj->GetString("Configuration.ini"));
+				if (!CR->Data) {
+					auto ent{ JD->Entry(bcFile) }; BoolAssert(ent, "JCR6 failed to get data for '" + bcFile + "'  (" + JCR6::Last()->ErrorMessage + ")");
+					CR->Data = STBConfig(ent->MainFile);
+					BoolAssert(CR->Data, "Parsing GINIE failed! Delete the STB file and try again! ");
+				}
 			} else {
 				if (force) Verb("Status", "Forced"); else Verb("Status", "Outdated");
 			}
@@ -1012,24 +1328,57 @@ public:
 				//QCol->Doing("-> Macro " + M, CR->Data->Value("Macros", M)); // DEBUG ONLY!!
 				(*Macros)[M] = CR->Data->Value("Macros", M);
 			}
+			Interface = InterfaceDigest(CR->Data);
+			if (TransKept) {
+				auto I{ std::make_shared<_TransImport>() };
+				for (auto& glob : *CR->Data->List("Globals", "-List-")) I->Globals[glob] = CR->Data->Value("Globals", glob);
+				for (auto M : *GetMacros) I->Macros[M] = CR->Data->Value("Macros", M);
+				I->Interface = Interface;
+				TransKept->Imports[Upper(srFile)] = I;
+			}
 		}
+		// Recorded for the incremental build checks. See ScyndiProject.cpp
+		Ret->Trans->Data->AddNew("Build", "Dependencies", Para);
+		Ret->Trans->Data->Value("Build::Dependencies", Para, Interface);
 
 		UseDependencies->push_back(Para);
 		return true;
 	}
 
+	bool DebugLineCalls(GINIE PrjData, bool debug) { return debug && PrjData && Upper(PrjData->Value("Debug", "LineCalls")) == "TRUE"; }
+
+	size_t InlineBudget(GINIE PrjData, bool debug) {
+		const size_t Default{ 32 };
+		if (debug) return 0; // Debug builds keep every call, so the debugger sees them.
+		if (!PrjData) return Default;
+		auto V{ Upper(PrjData->Value("Translation", "Inline")) };
+		if (V == "" || V == "TRUE") return Default;
+		if (V.find_first_not_of("0123456789") != std::string::npos) return 0; // FALSE, or anything else that's not a number
+		return (size_t)std::stoul(V);
+	}
+
 	Translation Translate(Slyvina::VecString sourcelines, std::string srcfile, Slyvina::JCR6::JT_Dir JD, GINIE dat, bool debug, bool force) {
-		std::string StaticRegister = "ScyndiStaticRegister_" + md5(srcfile) + md5(CurrentDate()) + md5(CurrentTime());
+		auto LineCalls{ DebugLineCalls(dat, debug) };
+		auto Budget{ InlineBudget(dat, debug) };
+		// In deterministic mode generated names are derived from the file name and the source in stead of the moment of translation.
+		std::string SourceDigest{ "" };
+		if (TransDeterministic) {
+			for (auto& l : *sourcelines) SourceDigest += l + "\n";
+			SourceDigest = md5(SourceDigest);
+		}
+		std::string Salt{ TransDeterministic ? md5(srcfile + SourceDigest) : md5(CurrentDate()) + md5(CurrentTime()) };
+		std::string StaticRegister = "ScyndiStaticRegister_" + md5(srcfile) + Salt;
 		std::vector<std::string> UseDependencies{};
 		std::map<String, String>Macros{};
 		Verb("Compiling", srcfile);
 		_TLError = "";
 		_TransProcess Ret;
 		Ret.Trans = std::make_shared<_Translation>();
+		if (TransDeterministic) Ret.Trans->Data = ParseGINIE("[Create]\nSource=" + SourceDigest);
 		//uint64 ScopeLevel{ 0 };
 
 		// The := statement and link keyword
-
+		PhaseTimer PTPre{ "Preprocess" };
 		for (size_t l = 1; l < sourcelines->size(); l++) {
 			auto line{ Trim( (*sourcelines)[l]) };
 			auto found{ false };
@@ -1077,10 +1426,14 @@ public:
 		}
 
 
+		PTPre.Stop();
 		// Chopping
+		PhaseTimer PTChop{ "Chop" };
 		Ret.Instructions = ChopCode(sourcelines, srcfile, JD, debug, &Macros);
+		PTChop.Stop();
 		if (!Ret.Instructions.size()) return nullptr; // Something must have gone wrong
 		// Include
+		PhaseTimer PTInclude{ "Include" };
 	StartInclude:
 		for (size_t ln = 0; ln < Ret.Instructions.size(); ln++) {
 			auto Ins = Ret.Instructions[ln];
@@ -1094,13 +1447,22 @@ public:
 					TransAssert(_file->Kind == WordKind::String, "#INCLUDE expects a string for a filename");
 					Verb("=> Including", _file->TheWord);
 					std::vector<Instruction> IncChopped{};
+					// ChopCode() puts the macros into the lines it gets, so kept lines are only handed over as a copy.
+					auto Kept{ TransKept && TransKept->Includes.count(_file->TheWord) ? TransKept->Includes[_file->TheWord] : VecString{ nullptr } };
+					auto Keep{ [&](VecString Lines) {
+						if (!TransKept) return Lines;
+						TransKept->Includes[_file->TheWord] = Lines;
+						auto isrc{ NewVecString() };
+						*isrc = *Lines;
+						return isrc;
+					} };
 					if (FileExists(_file->TheWord)) {
-						auto isrc = LoadLines(_file->TheWord);
-						IncChopped = ChopCode(isrc, srcfile, JD, debug, &Macros);
+						auto isrc = Keep(Kept ? Kept : LoadLines(_file->TheWord));
+						IncChopped = ChopCode(isrc, _file->TheWord, JD, debug, &Macros);
 						Ret.Trans->RealIncludes->push_back(_file->TheWord);
 					} else if (JD->EntryExists(_file->TheWord)) {
-						auto isrc = JD->GetLines(_file->TheWord);
-						IncChopped = ChopCode(isrc, srcfile, JD, debug, &Macros);
+						auto isrc = Keep(Kept ? Kept : JD->GetLines(_file->TheWord));
+						IncChopped = ChopCode(isrc, _file->TheWord, JD, debug, &Macros);
 						Ret.Trans->JCRIncludes->push_back(_file->TheWord);
 					} else {
 						TransError("Inclusion of " + _file->TheWord + " failed!\nFile not found");
@@ -1115,8 +1477,10 @@ public:
 				}
 			}
 		}
+		PTInclude.Stop();
 #pragma region "Pre-processing"
 		// Pre-Processing
+		PhaseTimer PTAnalysis{ "Analysis" };
 		Verb("Pre-processing", srcfile);
 		std::map<std::string, Word> TransConfig;
 		std::map<std::string, bool> Defs;
@@ -1139,7 +1503,54 @@ public:
 			auto DecScope{ false }; // needed this way to end declaration scopes abruptly
 			//*
 			//Chat(ins->Words.size());
-			if (ins->Words.size() && ins->Words[0]->UpWord == "CONSTRUCTOR") {
+			if (ins->Scope == ScopeKind::Record && (!MuteByIfDef) && !(ins->Words.size() && ins->Words[0]->TheWord == "#")) {
+				// Record fields. No code is generated for these.
+				DecScope = true;
+				ins->Kind = InsKind::RecordField;
+				auto RD{ ins->ScopeData->RecordData };
+				if (ins->Words.size() && ins->Words[0]->UpWord == "END") {
+					TransAssert(ins->Words.size() == 1, "END does not take any parameters or anything");
+					TransAssert(RD->Fields.size(), "Record " + RD->Name + " has no fields");
+					Ret.Scopes.pop_back();
+				} else if (ins->Words.size()) {
+					_RecordField F;
+					F.TypeName = ins->Words[0]->UpWord;
+					if (Prefixed(F.TypeName, "@")) {
+						auto Sub{ ins->ScopeData->Record(F.TypeName.substr(1)) };
+						TransAssert(Sub, "Only records can be used as field types in records. " + F.TypeName.substr(1) + " is not a record (records must be defined before they are used)");
+						F.Type = VarType::Table;
+						F.Record = Sub->Name;
+						F.Value = RecordValue(Sub);
+					} else {
+						TransAssert(_Declaration::S2E.count(F.TypeName), "Type expected for record field");
+						F.Type = _Declaration::S2E[F.TypeName];
+						TransAssert(F.Type != VarType::Void, "Void reserved for functions only");
+						switch (F.Type) {
+						case VarType::Number:
+						case VarType::Integer:
+						case VarType::Byte: F.Value = "0"; break;
+						case VarType::Boolean: F.Value = "false"; break;
+						case VarType::String: F.Value = "\"\""; break;
+						case VarType::Table: F.Value = "{}"; break;
+						default: F.Value = "nil"; break;
+						}
+					}
+					TransAssert(ins->Words.size() >= 2 && ins->Words[1]->Kind == WordKind::Identifier, "Identifier expected for record field");
+					F.Name = ins->Words[1]->UpWord;
+					TransAssert(!RD->Field(F.Name), "Dupe field " + F.Name + " in record " + RD->Name);
+					if (ins->Words.size() > 2) {
+						TransAssert(ins->Words.size() == 4 && ins->Words[2]->TheWord == "=", "Record field syntax error");
+						auto Lit{ ins->Words[3] };
+						TransAssert(Lit->Kind == WordKind::String || Lit->Kind == WordKind::Number || Lit->UpWord == "TRUE" || Lit->UpWord == "FALSE" || Lit->UpWord == "NIL", "Default values of record fields can only be literals");
+						auto Err{ RecordLiteralError(RD->Name, F, Lit) };
+						TransAssert(!Err.size(), Err);
+						if (Lit->Kind == WordKind::String) F.Value = "\"" + Lit->TheWord + "\"";
+						else if (Lit->Kind == WordKind::Number) F.Value = Lit->TheWord;
+						else F.Value = Lower(Lit->UpWord);
+					}
+					RD->Fields.push_back(F);
+				}
+			} else if (ins->Words.size() && ins->Words[0]->UpWord == "CONSTRUCTOR") {
 				Chat("Constructor!");
 				TransAssert(ins->Scope == ScopeKind::Class, TrSPrintF("(%d) Constructors can only be created in classes",(int)ins->Scope));
 				auto dec = std::make_shared<_Declaration>();
@@ -1211,7 +1622,10 @@ public:
 					if (ins->Words[pos]->UpWord == "SET") dec->IsSet = true;
 				}
 				TransAssert(pos < ins->Words.size(), "Incomplete declaration");
-				if (Prefixed(ins->Words[pos]->UpWord, "@")) {
+				if (Prefixed(ins->Words[pos]->UpWord, "@") && ins->ScopeData->Record(ins->Words[pos]->UpWord.substr(1))) {
+					dec->Type = VarType::Table;
+					dec->Record = ins->Words[pos]->UpWord.substr(1);
+				} else if (Prefixed(ins->Words[pos]->UpWord, "@")) {
 					dec->Type = VarType::CustomClass;
 					dec->CustomClass = ins->Words[pos]->UpWord.substr(1);
 				} else {
@@ -1536,8 +1950,7 @@ public:
 				TransAssert(S->Kind != ScopeKind::Root, "Cannot start a SWITCH in the root scope");
 				TransAssert(S->Kind != ScopeKind::Class, "Cannot start a SWITCH in a class scope");
 				TransAssert(S->Kind != ScopeKind::Switch, "Double Switch");
-				static size_t countswitch{ 0 };
-				auto switchname{ TrSPrintF("_Scyndi_Switch_%08x_",countswitch++) }; switchname += md5(srcfile + switchname) + "_";
+				auto switchname{ TrSPrintF("_Scyndi_Switch_%08x_",Ret.Count("Switch")) }; switchname += md5(srcfile + switchname) + "_";
 				ins->Kind = InsKind::Switch;
 				Ret.PushScope(ScopeKind::Switch);
 				auto NS{ Ret.GetScope() };
@@ -1610,13 +2023,21 @@ public:
 				ins->Words = Nw;
 			} else if (ins->Words[0]->UpWord == "RETURN") {
 				TransAssert(Ret.GetScope()->Kind != ScopeKind::Root, "Return instructions not allowed in the root scope");
+				for (auto S = Ret.GetScope().get(); S && S->Kind != ScopeKind::FunctionBody && S->Kind != ScopeKind::Method && S->Kind != ScopeKind::Init && S->Kind != ScopeKind::QFuncBody; S = S->Parent)
+					TransAssert(S->Kind != ScopeKind::Defer, "Return instructions not allowed in a DEFER block");
 				ins->Kind = InsKind::Return;
 			} else if (ins->Words[0]->UpWord == "DEFER") {
 				TransAssert(ins->Scope == ScopeKind::FunctionBody || ins->Scope == ScopeKind::Method || ins->Scope == ScopeKind::Init, "Defer can only be used inside a function/method/init scope");
 				ins->Kind = InsKind::Defer;
 				Ret.PushScope(ScopeKind::Defer);
-			} else if (ins->Words[0]->UpWord == "CLASS" || ins->Words[0]->UpWord=="GROUP") {
+			} else if (ins->Words[0]->UpWord == "CLASS" || ins->Words[0]->UpWord=="GROUP" || ins->Words[0]->UpWord=="POOLED") {
 				// start class
+				// POOLED CLASS: Instances can be given back with Release(), and New() recycles those.
+				auto Pooled{ ins->Words[0]->UpWord == "POOLED" };
+				if (Pooled) {
+					TransAssert(ins->Words.size() > 1 && ins->Words[1]->UpWord == "CLASS", "POOLED can only be used for classes");
+					ins->Words.erase(ins->Words.begin());
+				}
 				TransAssert(ins->ScopeData->Kind == ScopeKind::Root, "Class can only be created in root scope");
 				ins->Kind = InsKind::StartClass;
 				if (ins->Words.size() < 2) TransError("Incomplete class defintion");
@@ -1624,6 +2045,7 @@ public:
 				Ret.PushScope(ins->Words[0]->UpWord == "CLASS" ? ScopeKind::Class : ScopeKind::Group);
 				auto SC{ Ret.GetScope() };
 				SC->ClassID = ins->Words[1]->TheWord;
+				if (Pooled) Ret.PooledClasses[Upper(SC->ClassID)] = true;
 				(*Ret.Trans->GlobalVar)[SC->ClassID] = "SCYNDI.CLASSES[\"" + SC->ClassID + "\"]";
 				Ret.Trans->Data->Add("CLASSES", "CLASS", Upper(SC->ClassID));
 				(*SC->LocalVars)["SELF"] = "Scyndi.Class[\"" + SC->ClassID + "\"]";
@@ -1635,6 +2057,17 @@ public:
 				}
 				Ret.Trans->Data->Value("Globals", SC->ClassID, (*SC->LocalVars)["SELF"]);
 				Ret.Trans->Data->Add("Globals", "-list-", Upper(SC->ClassID));
+			} else if (ins->Words[0]->UpWord == "RECORD") {
+				// RECORD Name: Typed fields only. The fields are checked while translating, and Lua only gets to see plain tables.
+				TransAssert(ins->ScopeData->Kind == ScopeKind::Root, "Records can only be defined in the root scope");
+				TransAssert(ins->Words.size() == 2 && ins->Words[1]->Kind == WordKind::Identifier, "RECORD syntax error");
+				TransAssert(!ins->ScopeData->Record(ins->Words[1]->UpWord), "Dupe record " + ins->Words[1]->TheWord);
+				ins->Kind = InsKind::StartRecord;
+				Ret.PushScope(ScopeKind::Record);
+				auto RD{ std::make_shared<_RecordDef>() };
+				RD->Name = ins->Words[1]->UpWord;
+				Ret.RootScope->Records[RD->Name] = RD;
+				Ret.GetScope()->RecordData = RD;
 			} else if (ins->Words[0]->UpWord == "EXTERN") {
 				TransAssert(ins->Words.size() >= 3, TrSPrintF("EXTERN incomplete (%d/3)", ins->Words.size()));
 				TransAssert(ins->Words[1]->Kind == WordKind::Identifier, "EXTERN expects identifier");
@@ -1731,8 +2164,7 @@ public:
 				Ret.PushScope(ScopeKind::QFuncBody);
 				//auto QFBS{ Ret.GetScope() };
 				if (ins->Words[0]->UpWord == "DDEF") {
-					static int C{ 0 };
-					(*Parent->LocalVars)[ins->Words[1]->UpWord] = TrSPrintF("SCYNDI_QUICKFUNCTION_VARIABLE_%d", C++) + "_" + md5(CurrentDate()) + "_" + md5(CurrentTime());
+					(*Parent->LocalVars)[ins->Words[1]->UpWord] = TrSPrintF("SCYNDI_QUICKFUNCTION_VARIABLE_%d", (int)Ret.Count("DDEF")) + "_" + Salt;
 					ins->ForVars.clear(); ins->ForVars.push_back((*Parent->LocalVars)[ins->Words[1]->UpWord]); // Dirty, but good enough here.
 				} else {
 					TransAssert(Ret.Identifier(ins->Words[1]->UpWord).size(),"Unknown identifier ("+ins->Words[1]->TheWord+") for LDEF definition");
@@ -1781,9 +2213,8 @@ public:
 					//TransAssert(ins->Words.size() >= endexpression + 2, "Unfinished regular FOR");
 				}
 				for (auto& loc : ForVars) {
-					static size_t count{ 0 };
 					auto sv{ Ret.GetScope()->LocalVars };
-					(*sv)[loc] = TrSPrintF("__Scyndi_For_Variable_%08x_%s", count++, md5(loc).c_str());
+					(*sv)[loc] = TrSPrintF("__Scyndi_For_Variable_%08x_%s", Ret.Count("For"), md5(loc).c_str());
 					Ret.GetScope()->LocalDeclaLine[loc] = ins->LineNumber;
 					ins->ForVars.push_back(loc);
 					(*ins->ForTrans)[loc] = (*sv)[loc];
@@ -1841,25 +2272,70 @@ public:
 		}
 		auto Trans{ &Ret.Trans->LuaSource };
 		*Trans = "-- " + StripDir(srcfile) + "\n";
-		*Trans += "--[[ Script Generated by Scyndi on " + CurrentDate() + ", " + CurrentTime() + "]]\n\n";
+		if (TransDeterministic)
+			*Trans += "--[[ Script Generated by Scyndi ]]\n\n";
+		else
+			*Trans += "--[[ Script Generated by Scyndi on " + CurrentDate() + ", " + CurrentTime() + "]]\n\n";
 		if (debug) *Trans += "--[[ DEBUG TRANSLATION ]]--\n\n";
+		// MapLine must be called before an instruction generates its code. Only when it did generate anything, it goes into the line map.
+		// Lua lines are counted as the translation grows, so the translation is scanned only once.
+		Ret.Trans->Lines = NewLineMap(LineMapChunk(srcfile));
+		Instruction MapPending{ nullptr };
+		size_t MapStart{ 0 }, MapCounted{ 0 };
+		uint32 MapLuaLine{ 1 };
+		// While a DEFER block is translated, Trans points to DeferCode, and the line map waits.
+		std::string* DeferMain{ nullptr };
+		std::string DeferCode{ "" };
+		_Scope* DeferTarget{ nullptr };
+		auto MapLine{ [&](Instruction Ins) {
+			if (DeferMain) return;
+			if (MapPending && Trans->size() > MapStart) {
+				for (; MapCounted < MapStart; MapCounted++) if ((*Trans)[MapCounted] == '\n') MapLuaLine++;
+				Ret.Trans->Lines->Add(MapLuaLine, MapPending->SourceFile, MapPending->LineNumber);
+			}
+			MapPending = Ins;
+			MapStart = Trans->size();
+		} };
 		*Trans += TrSPrintF("local %s = Scyndi.STARTCLASS(\"%s\",true,true,nil)\n", ScriptName.c_str(), ScriptName.c_str());
 		*Trans += TrSPrintF("local %s = {}\n", StaticRegister.c_str());
+		// Static locals become chunk locals, declared on the line above once everything is translated (see "Static Local" below).
+		// No new lines in there, so the line map remains correct.
+		auto StaticHoist{ Trans->size() - 1 };
+		std::string StaticLocals{ "" };
+		// Lua allows 200 locals per function, and the chunk is a function too. All chunk locals count against one budget.
+		// Static locals only get what's left after all the others, and go the old way through the static register beyond that.
+		// The headroom is for the loop running the INIT blocks.
+		const size_t MaxChunkLocals{ 190 };
+		size_t ChunkLocals{ 3 }; // The script's class, the static register and the class descriptors
 		for (auto& dep : UseDependencies) *Trans += TrSPrintF("Scyndi.Use( \"%s\" )\n ", dep.c_str());
 #pragma endregion
 
+		PTAnalysis.Stop();
 #pragma region "Class and group startups"
 		// Class management
 		// TODO!
-		std::vector<std::string> ToSeal;
+		PhaseTimer PTDeclaration{ "Declaration" };
+		// The globals and the script's own class already exist, and only get members from this translation. 
+		// The class descriptors all go in one chunk local, as a script can have more classes than Lua can have locals.
+		auto ClassDescs{ "ScyndiClasses_" + Salt };
+		auto NewClassDesc{ [&](std::string Name, bool Start) {
+			auto CU{ Upper(Name) };
+			auto& D{ Ret.ClassDescs[CU] };
+			D.Name = CU;
+			D.Start = Start;
+			D.Local = TrSPrintF("%s[%d]", ClassDescs.c_str(), (int)Ret.Count("ClassDesc") + 1);
+			Ret.ClassDescOrder.push_back(CU);
+			return &D;
+		} };
+		NewClassDesc("..GLOBALS..", false);
+		NewClassDesc(ScriptName, false);
 		for (auto Ins : Ret.Instructions) {
 			auto LineNumber{ Ins->LineNumber };
 			switch (Ins->Kind) {
-			case InsKind::StartClass:
-				ToSeal.push_back(Ins->Words[1]->UpWord);
-				*Trans += "Scyndi.StartClass(\"";
-				*Trans += Ins->Words[1]->UpWord + "\", ";
-				*Trans += "true, true";
+			case InsKind::StartClass: {
+				TransAssert(!Ret.ClassDesc(Ins->Words[1]->UpWord), "Duplicate class name: " + Ins->Words[1]->TheWord);
+				auto D{ NewClassDesc(Ins->Words[1]->UpWord, true) };
+				D->Pooled = Ret.PooledClasses.count(Ins->Words[1]->UpWord);
 				// ,extends )
 				if (Ins->Words.size() > 2) {
                         //TransError("Extended classes not yet supported");
@@ -1867,11 +2343,10 @@ public:
                         QCol->LCyan(Ins->Words[1]->TheWord);
                         QCol->Yellow(" extends ");
                         QCol->LCyan(Ins->Words[3]->TheWord+"\n");
-                        *Trans += ", \""+Ins->Words[3]->UpWord+"\"";
+                        D->Extends = Ins->Words[3]->UpWord;
 				}
-				*Trans += ")\n";
 				(*Ret.Trans->GlobalVar)[Ins->Words[1]->UpWord] = "Scyndi.Classes." + Ins->Words[1]->UpWord;
-				break;
+			} break;
 			case InsKind::StartGroup:
 				TransError("Groups not yet supported");
 			}
@@ -1882,11 +2357,56 @@ public:
 #pragma region "Declare non-locals"
 		// Declaration management
 		Verb("Managing", srcfile);
+		// Registers a name in a class descriptor. Returns an error message when that's a dupe.
+		auto DescName{ [&](std::string Class, std::string Name, std::string What) -> std::string {
+			auto D{ Ret.ClassDesc(Class) };
+			if (!D) return "Internal error! No descriptor for class " + Class + " (Please report!)";
+			if (D->Names.count(Name) && !(What == "property" && D->Names[Name] == What) && !(What == "method" && D->Names[Name] == "abstract"))
+				return "Class " + Class + " already has a " + D->Names[Name] + " named " + Name;
+			D->Names[Name] = What;
+			return "";
+		} };
+		// Adds a member to a class descriptor. Lit is the literal value, if it's one.
+		// Literal values of a built-in type are checked here, so the core doesn't have to. Those it would refuse are an error right away.
+		// Anything else must be evaluated after the members before it, so that goes in as a function.
+		auto DescMember{ [&](Instruction Ins, std::string Class, std::string DType, std::string VarName, bool IsStatic, bool IsReadOnly, bool IsConstant, std::string Value, Word Lit, bool IsDefault, std::string Fresh = "") -> std::string {
+			auto Err{ DescName(Class, VarName, "member") };
+			if (Err.size()) return Err;
+			auto UDT{ Upper(DType) };
+			bool
+				IsInt{ UDT == "INT" || UDT == "INTEGER" || UDT == "BYTE" },
+				IsNum{ IsInt || UDT == "NUMBER" },
+				IsRef{ UDT == "TABLE" || UDT == "DELEGATE" || UDT == "FUNCTION" },
+				Checked{ false };
+			if (IsDefault) {
+				Checked = IsNum || IsRef || UDT == "BOOLEAN" || UDT == "BOOL" || UDT == "STRING" || UDT == "VAR" || UDT == "PLUA";
+			} else if (Lit) {
+				auto Digits{ Lit->Kind == WordKind::Number && Lit->TheWord.size() && Lit->TheWord.find_first_not_of("0123456789") == std::string::npos };
+				if (Lit->Kind == WordKind::String && IsNum) return "Number expected for " + VarName + ", but got a string";
+				if (IsRef) return TrSPrintF("%s expected for %s, but got a literal value", DType.c_str(), VarName.c_str());
+				if (UDT == "BYTE") Checked = Digits && Lit->TheWord.size() < 4 && std::stoi(Lit->TheWord) < 256;
+				else if (IsInt) Checked = Digits;
+				else if (IsNum) Checked = Lit->Kind == WordKind::Number;
+				else if (UDT == "STRING") Checked = Lit->Kind == WordKind::String;
+				else if (UDT == "BOOLEAN" || UDT == "BOOL") Checked = Lit->Kind == WordKind::KeyWord;
+				else Checked = UDT == "VAR" || UDT == "PLUA";
+			}
+			auto Entry{ "{\"" + VarName + "\", \"" + DType + "\", " + lboolstring(IsStatic) + ", " + lboolstring(IsReadOnly) + ", " + lboolstring(IsConstant) + ", " };
+			if (IsDefault || Lit)
+				Entry += Value + ", " + lboolstring(Checked);
+			else
+				Entry += "function() return " + Value + " end, false, " + std::to_string(Ret.Count("LazyMember"));
+			if (Fresh.size()) Entry += std::string(IsDefault || Lit ? ", nil" : "") + ", function() return " + Fresh + " end";
+			Entry += "}";
+			Ret.ClassDesc(Class)->Members.push_back({ Ins,Entry });
+			return "";
+		} };
 		for (auto Ins : Ret.Instructions) {
 			auto LineNumber{ Ins->LineNumber };
 			auto Dec{ Ins->DecData };
 			TVV("Ins line: "<<Ins->LineNumber);
 			if (Dec) {
+				MapLine(Ins);
 				auto VarName{ Ins->Words[Ins->ForEachExpression]->UpWord };
 				auto PluaName{ Ins->Words[Ins->ForEachExpression]->TheWord };
 				std::string Value{ "" };
@@ -1925,6 +2445,7 @@ public:
 							auto ref{ TrSPrintF("%s%s",Prefix.c_str(),PluaName.c_str()) };
 							(*Ret.RootScope->LocalVars)[VarName] = ref;
 							*Trans += "local " + ref+"\n"; // Will prevent trouble later! That's the only code that SHOULD be written.
+							ChunkLocals++;
 							//std::cout << "Registered local plua " << VarName << " as " << ref << "\n"; // debug only
 						} else {
 							auto ref{ TrSPrintF("Scyndi.Class[\"%s\"][\"%s\"]",ScriptName.c_str(),VarName.c_str()) };
@@ -1945,6 +2466,7 @@ public:
 					} else {
 						TransAssert(!Ret.ClassProperty[FClass][VarName].hasset, "Dupe property-set ");
 					}
+					{ auto Err{ DescName(FClass, VarName, "property") }; TransAssert(!Err.size(), Err); }
 					Ret.ClassProperty[FClass][VarName].hasget = true;
 					if (Dec->IsGlobal) {
 						auto ref{ TrSPrintF("Scyndi.Globals[\"%s\"]",VarName.c_str()) };
@@ -1964,8 +2486,12 @@ public:
 					}
 				} break;
 
-				case InsKind::Declaration:
-					if (Ins->Words.size() == Ins->ForEachExpression + 1) {
+				case InsKind::Declaration: {
+					Word Lit{ nullptr };
+					bool IsDefault{ Ins->Words.size() == Ins->ForEachExpression + 1 };
+					if (IsDefault && Dec->Record.size()) {
+						Value = RecordValue(Ins->ScopeData->Record(Dec->Record));
+					} else if (IsDefault) {
 						switch (Dec->Type) {
 						case VarType::Number:
 						case VarType::Integer:
@@ -1991,19 +2517,29 @@ public:
 						auto EX{ Expression(Ret.Trans,Ins,Ins->ForEachExpression + 2) };
 						if (!EX) return nullptr;
 						Value = *EX;
+						if (Ins->Words.size() == Ins->ForEachExpression + 3) {
+							auto W{ Ins->Words[Ins->ForEachExpression + 2] };
+							if (W->Kind == WordKind::String || W->Kind == WordKind::Number || W->UpWord == "TRUE" || W->UpWord == "FALSE") Lit = W;
+						}
 					}
 					// std::cout << "Dec In Class '" << Dec->BoundToClass << "';\n"; //debug
 					if (Dec->BoundToClass.size()) {
 						auto ref{ TrSPrintF("Scyndi.Class[\"%s\"][\"%s\"]",Dec->BoundToClass.c_str(),VarName.c_str()) };
 						//*Trans += TrSPrintF("Scyndi.ADDMBER(\"%s\",\"%s\",\"%s\",%s,%s,%s,%s)\n", Dec->BoundToClass.c_str(), DType.c_str(), VarName.c_str(), lboolstring(Dec->IsStatic).c_str(), lboolstring(Dec->IsReadOnly).c_str(), Lower(boolstring(Dec->IsConstant)).c_str(), Value.c_str());
-						*Trans+="Scyndi.ADDMBER(\""+Dec->BoundToClass+"\", \""+DType+"\", \""+VarName+"\", "+lboolstring(Dec->IsStatic)+", "+lboolstring(Dec->IsReadOnly)+", "+lboolstring(Dec->IsConstant)+", "+ Value+")\n";
+						// Every instance needs a record of its own, so the value is made again for every instance.
+						auto Fresh{ Dec->Record.size() && !Dec->IsStatic ? Value : "" };
+						auto Err{ DescMember(Ins, Dec->BoundToClass, DType, VarName, Dec->IsStatic, Dec->IsReadOnly, Dec->IsConstant, Value, Lit, IsDefault, Fresh) };
+						TransAssert(!Err.size(), Err);
 						if (Dec->IsStatic) {
 							(*Ins->ScopeData->DecScope()->LocalVars)[VarName] = ref;
+							if (Dec->Record.size()) Ins->ScopeData->DecScope()->RecordVars[VarName] = Dec->Record;
 						} else {
 							Ret.Fields[Upper(Dec->BoundToClass)].push_back(VarName);
+							if (Dec->Record.size()) Ret.RecordFields[Upper(Dec->BoundToClass)][VarName] = Dec->Record;
 						}
 						if (Dec->IsGlobal) TransError("GLOBAL not allowed for class members");
 					} else if (Dec->IsGlobal) {
+						if (Dec->Record.size()) Ret.RootScope->RecordVars[VarName] = Dec->Record;
 						if (Dec->Type == VarType::pLua) {
 							std::string Prefix{ "" }; if (TransConfig.count("PLUAPREFIX")) Prefix = TransConfig["PLUAPREFIX"]->TheWord;
 							auto ref{ TrSPrintF("%s%s",Prefix.c_str(),PluaName.c_str()) };
@@ -2017,35 +2553,189 @@ public:
 							Ret.Trans->Data->Value("Globals", VarName, ref);
 							(*Ret.Trans->GlobalVar)[VarName] = ref;
 							//Scyndi.ADDMBER(ch,dtype,name,static,readonly,constant,value)
-							*Trans += TrSPrintF("Scyndi.ADDMBER(\"..GLOBALS..\",\"%s\",\"%s\",true,%s,%s,%s)\n", DType.c_str(), VarName.c_str(), Lower(boolstring(Dec->IsReadOnly)).c_str(), Lower(boolstring(Dec->IsConstant)).c_str(), Value.c_str());
+							auto Err{ DescMember(Ins, "..GLOBALS..", DType, VarName, true, Dec->IsReadOnly, Dec->IsConstant, Value, Lit, IsDefault) };
+							TransAssert(!Err.size(), Err);
 						}
 					} else if (Dec->IsRoot) {
 						if (Dec->Type == VarType::pLua) {
 							std::string Prefix{ "" }; if (TransConfig.count("PLUAPREFIX")) Prefix = TransConfig["PLUAPREFIX"]->TheWord;
 							auto ref{ TrSPrintF("%s%s",Prefix.c_str(),PluaName.c_str()) };
 							*Trans += TrSPrintF("local %s = %s\n", ref.c_str(), Value.c_str());
+							ChunkLocals++;
 							(*Ret.RootScope->LocalVars)[VarName] = ref;
 						} else {
 							auto ref{ TrSPrintF("Scyndi.Class[\"%s\"][\"%s\"]",ScriptName.c_str(),VarName.c_str()) };
 							(*Ret.RootScope->LocalVars)[VarName] = ref;
 							//Scyndi.ADDMBER(ch,dtype,name,static,readonly,constant,value)
 							//*Trans += TrSPrintF("Scyndi.ADDMBER(\"%s\",\"%s\",\"%s\",true,%s,%s,%s)\n", ScriptName.c_str(), DType.c_str(), VarName.c_str(), Lower(boolstring(Dec->IsReadOnly)).c_str(), Lower(boolstring(Dec->IsConstant)).c_str(), Value.c_str());
-							*Trans += "Scyndi.ADDMBER(\""+ScriptName+"\", \""+DType+"\", \""+VarName+"\", true, "+lboolstring(Dec->IsReadOnly)+", "+lboolstring(Dec->IsConstant)+", "+Value+")";
+							auto Err{ DescMember(Ins, ScriptName, DType, VarName, true, Dec->IsReadOnly, Dec->IsConstant, Value, Lit, IsDefault) };
+							TransAssert(!Err.size(), Err);
 						}
+						if (Dec->Record.size()) Ret.RootScope->RecordVars[VarName] = Dec->Record;
 					}
+				} break;
 				}
 			}
 		}
+		MapLine(nullptr);
+		// The class descriptors. Functions, methods, properties and abstracts are added to these as they are translated below.
+		*Trans += "local " + ClassDescs + " = {}\n";
+		for (auto& CN : Ret.ClassDescOrder) {
+			auto& D{ Ret.ClassDescs[CN] };
+			*Trans += D.Local + " = { Name=\"" + D.Name + "\", Start=" + lboolstring(D.Start);
+			if (D.Start) *Trans += ", Static=true, Sealable=true, Seal=true";
+			if (D.Pooled) *Trans += ", Pooled=true";
+			if (D.Extends.size()) *Trans += ", Extends=\"" + D.Extends + "\"";
+			*Trans += ",\n\tMembers={\n";
+			for (auto& M : D.Members) {
+				MapLine(M.first);
+				*Trans += "\t\t" + M.second + ",\n";
+			}
+			MapLine(nullptr);
+			*Trans += "\t},\n\tMethods={}, Finals={}, Functions={}, Abstracts={}, Get={}, Set={}, StaticGet={}, StaticSet={} }\n";
+		}
 #pragma endregion
 
+		PTDeclaration.Stop();
 #pragma region "Actual Translation"
 		// Translate
+		PhaseTimer PTCodegen{ "Codegen" };
 		Verb("Translating", srcfile);
-		auto InitTag{ TrSPrintF("__Scyndi__Init__%s",md5(srcfile + CurrentDate() + CurrentTime()).c_str()) };
-		if (HasInit) *Trans += "\nlocal " + InitTag + " = {}\n";
+		auto InitTag{ TrSPrintF("__Scyndi__Init__%s",md5(srcfile + Salt).c_str()) };
+		if (HasInit) { *Trans += "\nlocal " + InitTag + " = {}\n"; ChunkLocals++; }
+		// DDEF quick functions which are only a RETURN can be inlined, and so can root functions and static functions in classes.
+		// Which ones are, is decided when that RETURN is translated. Calls before that point remain calls.
+		// FINAL methods are called on instances of which the translator doesn't know the class, so those are never inlined.
+		std::map<_Instruction*, Instruction> InlineReturns{};
+		if (Budget) {
+			auto Next{ [&](size_t i) { do i++; while (i < Ret.Instructions.size() && Ret.Instructions[i]->Kind == InsKind::WhiteLine); return i; } };
+			for (size_t i = 0; i < Ret.Instructions.size(); i++) {
+				auto Ins{ Ret.Instructions[i] };
+				if (Ins->Kind == InsKind::QFuncDef && Ins->Words[0]->UpWord == "LDEF") {
+					Verb("Not inlined", Ins->Words[1]->TheWord + " (LDEF assigns a variable, which can be given another value at any time)");
+					continue;
+				}
+				auto Func{ (Ins->Kind == InsKind::DefineFunction && Ins->DecData->IsRoot && !Ins->DecData->IsGlobal) || (Ins->Kind == InsKind::StartMethod && Ins->DecData->IsStatic && Ins->DecData->BoundToClass.size()) };
+				if (Ins->Kind != InsKind::QFuncDef && !Func) continue;
+				auto Name{ Func ? Ins->Words[Ins->ForEachExpression]->TheWord : Ins->Words[1]->TheWord };
+				auto R{ Next(i) }, E{ Next(R) };
+				if (!(E < Ret.Instructions.size() && Ret.Instructions[R]->Kind == InsKind::Return && Ret.Instructions[E]->Kind == InsKind::EndScope && Ret.Instructions[E]->Scope == (Func ? ScopeKind::FunctionBody : ScopeKind::QFuncBody))) {
+					if (!Func) Verb("Not inlined", Name + " (more than a RETURN)");
+					continue;
+				}
+				if (Func) {
+					// Anything typed goes through WantValue, which an expression put in place of the call would skip.
+					if (Ins->DecData->Type != VarType::Var) { Verb("Not inlined", Name + " (the result is typed)"); continue; }
+					bool Typed{ false };
+					for (auto p = Ins->ForEachExpression + 2; p < Ins->Words.size() && Ins->Words[p]->TheWord != ")"; p++) Typed = Typed || (Ins->Words[p]->Kind != WordKind::Identifier && Ins->Words[p]->Kind != WordKind::Comma);
+					if (Typed) { Verb("Not inlined", Name + " (typed parameters)"); continue; }
+				}
+				InlineReturns[Ret.Instructions[R].get()] = Ins;
+			}
+		}
+		// Whether the RETURN of a quick function or function to inline, refers to things which could mean something else at the place of the call.
+		auto PlainLua{ [&](Instruction Ins) -> std::string {
+			for (size_t i = 1; i < Ins->Words.size(); i++) {
+				if (Ins->Words[i]->Kind != WordKind::Identifier) continue;
+				auto Id{ Ins->ScopeData->Identifier(Ret.Trans, Ins->LineNumber, Ins->Words[i]->UpWord) };
+				if (Id.find_first_of(".[") == std::string::npos && !Prefixed(Id, "SCYNDI_QUICKFUNCTION_VARIABLE_") && !Prefixed(Id, "ScyndiStaticRegister_")) return Ins->Words[i]->TheWord + " is a plain Lua name";
+			}
+			return "";
+		} };
+		// Returns why the quick function can't be inlined, or an empty string when it will be.
+		auto QuickInline{ [&](Instruction Ins, Instruction Def, std::string Ex) -> std::string {
+			auto& W{ Ins->Words };
+			if (W.size() - 1 > Budget) return TrSPrintF("%d words, where the budget is %d", (int)W.size() - 1, (int)Budget);
+			size_t Dots{ 0 }, At{ 0 }, Depth{ 0 };
+			bool Operator{ false }, Comma0{ false };
+			for (size_t i = 1; i < W.size(); i++) {
+				if (W[i]->UpWord == "INFINITY") { Dots++; At = i; }
+				if (W[i]->Kind == WordKind::HaakjeOpenen) Depth++;
+				else if (W[i]->Kind == WordKind::HaakjeSluiten && Depth) Depth--;
+				else if (!Depth && W[i]->Kind == WordKind::Comma) Comma0 = true;
+				else if (!Depth && (W[i]->Kind == WordKind::Operator || W[i]->UpWord == "AND" || W[i]->UpWord == "OR" || W[i]->UpWord == "NOT" || W[i]->UpWord == "DIV")) Operator = true;
+			}
+			auto Plain{ PlainLua(Ins) };
+			if (Plain.size()) return Plain;
+			if (Dots != 1) return "the arguments must be used exactly once";
+			if (At + 1 >= W.size() || W[At + 1]->Kind != WordKind::HaakjeSluiten) return "the arguments must be the last ones passed to a call";
+			auto Comma{ W[At - 1]->Kind == WordKind::Comma };
+			if (!Comma && !(W[At - 1]->Kind == WordKind::HaakjeOpenen && At > 2 && (W[At - 2]->Kind == WordKind::Identifier || W[At - 2]->Kind == WordKind::Field || W[At - 2]->Kind == WordKind::HaakjeSluiten))) return "the arguments must be the last ones passed to a call";
+			if (Comma0) return "more than one value is returned";
+			auto Dot{ Ex.find("...") };
+			if (Dot == std::string::npos || Ex.find("...", Dot + 1) != std::string::npos) return "the arguments must be used exactly once";
+			auto& QI{ Ins->ScopeData->Parent->Inlines[Def->ForVars[0]] };
+			QI.Pre = Ex.substr(0, Dot);
+			QI.Post = Ex.substr(Dot + 3);
+			QI.Comma = Comma;
+			QI.Wrap = Operator; // Without any operators it's a call, which can be put in as it is. That way all its return values remain.
+			return "";
+		} };
+		// The same for root and static functions. In the expression, their parameters are their locals: <ScopeLoc>["<PARAMETER>"].
+		auto FuncInline{ [&](Instruction Ins, Instruction Def, std::string Ex) -> std::string {
+			auto& W{ Ins->Words };
+			auto Name{ Def->Words[Def->ForEachExpression]->UpWord };
+			if (W.size() - 1 > Budget) return TrSPrintF("%d words, where the budget is %d", (int)W.size() - 1, (int)Budget);
+			size_t Depth{ 0 };
+			bool Operator{ false };
+			for (size_t i = 1; i < W.size(); i++) {
+				if (W[i]->UpWord == "INFINITY") return "INFINITY can't be inlined";
+				if (W[i]->UpWord == Name || (W[i]->Kind == WordKind::Field && Upper(W[i]->TheWord.substr(1)) == Name)) return "it may call itself";
+				if (W[i]->Kind == WordKind::HaakjeOpenen) Depth++;
+				else if (W[i]->Kind == WordKind::HaakjeSluiten && Depth) Depth--;
+				else if (!Depth && W[i]->Kind == WordKind::Comma) return "more than one value is returned";
+				else if (!Depth && (W[i]->Kind == WordKind::Operator || W[i]->UpWord == "AND" || W[i]->UpWord == "OR" || W[i]->UpWord == "NOT" || W[i]->UpWord == "DIV")) Operator = true;
+			}
+			auto Plain{ PlainLua(Ins) };
+			if (Plain.size()) return Plain;
+			std::vector<std::string> Params{};
+			for (auto p = Def->ForEachExpression + 2; p < Def->Words.size() && Def->Words[p]->TheWord != ")"; p++) if (Def->Words[p]->Kind == WordKind::Identifier) Params.push_back(Def->Words[p]->UpWord);
+			auto Loc{ Def->NextScope->ScopeLoc };
+			_Scope::QuickInline QI;
+			QI.Params = Params.size();
+			QI.Wrap = Operator;
+			QI.Ordered = true;
+			for (size_t From = 0; From != std::string::npos;) {
+				size_t At{ std::string::npos }, Which{ 0 };
+				for (size_t p = 0; p < Params.size(); p++) {
+					auto F{ Ex.find(Loc + "[\"" + Params[p] + "\"]", From) };
+					if (F < At) { At = F; Which = p; }
+				}
+				if (At == std::string::npos) {
+					QI.Pieces.push_back({ Ex.substr(From), std::string::npos });
+					From = At;
+				} else {
+					QI.Pieces.push_back({ Ex.substr(From, At - From), Which });
+					From = At + Loc.size() + Params[Which].size() + 4;
+				}
+			}
+			if (Loc.size()) for (auto& P : QI.Pieces) if (P.first.find(Loc) != std::string::npos) return "the parameters are used in a way that can't be inlined";
+			for (size_t i = 0; i < QI.Pieces.size(); i++) QI.Ordered = QI.Ordered && QI.Pieces[i].second == (i < Params.size() ? i : std::string::npos);
+			if (Def->Kind == InsKind::DefineFunction)
+				Ret.RootScope->Inlines[TrSPrintF("Scyndi.Class[\"%s\"][\"%s\"]", ScriptName.c_str(), Name.c_str())] = QI;
+			else
+				Ret.RootScope->Inlines["Scyndi.Classes." + Upper(Def->DecData->BoundToClass) + "." + Name] = QI;
+			return "";
+		} };
 		for (auto& Ins : Ret.Instructions) {
             TVV("Translating "<<srcfile<<" line #"<<Ins->LineNumber);
 			auto LineNumber{ Ins->LineNumber };
+			switch (Ins->Kind) {
+			case InsKind::WhiteLine:
+			case InsKind::CompilerDirective:
+			case InsKind::HeaderDefintion:
+			case InsKind::StartDeclarationScope:
+			case InsKind::StartClass:
+			case InsKind::StartGroup:
+			case InsKind::ExternImport:
+			case InsKind::MutedByIfDef:
+			case InsKind::StartRecord:
+			case InsKind::RecordField:
+			case InsKind::Defer:
+				break; // Nothing is generated for these
+			default:
+				MapLine(Ins);
+			}
 			if (Ins->Kind == InsKind::EndScope || Ins->Kind==InsKind::ElseIfStatement || Ins->Kind==InsKind::ElseStatement)
 				for (size_t tab = 1; tab < Ins->ScopeLevel; tab++) *Trans += '\t';
 			else
@@ -2061,6 +2751,8 @@ public:
 			case InsKind::StartDeclarationScope: // The declaration scoping is already taken care of while pre-processing.
 			case InsKind::StartClass: // Classes have already been taken care of
 			case InsKind::StartGroup: // Groups too
+			case InsKind::StartRecord: // Records only exist for the translator
+			case InsKind::RecordField:
 				break;
 			case InsKind::StartInit:
 				*Trans += InitTag + "[#" + InitTag + "+1]=function()\n";
@@ -2170,12 +2862,17 @@ public:
 					*Trans += "nil} -- DefTable Scope Ended --\n";
 					break;
 				case ScopeKind::Init:
-				case ScopeKind::Defer:
 					if (!Ins->ScopeData->DidReturn) {
-						if (Ins->Scope != ScopeKind::Defer) *Trans += Ins->ScopeData->DeferLine();
+						*Trans += Ins->ScopeData->DeferLine();
 						if (debug) *Trans += " Scyndi.Debug.Pop(); ";
-						*Trans += "end\n";
 					}
+					*Trans += "end\n";
+					break;
+				case ScopeKind::Defer:
+					TransAssert(DeferMain, "DEFER end without start (internal error! Please report!)");
+					DeferTarget->Defers.push_back(DeferCode);
+					Trans = DeferMain;
+					DeferMain = nullptr;
 					break;
 				case ScopeKind::Class:
 				case ScopeKind::Group:
@@ -2196,8 +2893,8 @@ public:
 					break;
 				case ScopeKind::FunctionBody:
 					if (!Ins->ScopeData->DidReturn) {
+						*Trans += Ins->ScopeData->DeferLine();
 						if (debug) *Trans += " Scyndi.Debug.Pop(); ";
-						if (Ins->Scope != ScopeKind::Defer) *Trans += Ins->ScopeData->DeferLine();
 						TransAssert(Ins->ScopeData->DecData, "Function body check. Dec data is null (internal error. Please report)")
 							switch (Ins->ScopeData->DecData->Type) {
 							case VarType::Void:
@@ -2252,7 +2949,9 @@ public:
 
 					auto p{ Ins->ForEachExpression + 1 };
 					std::string BaseValue;
-					if (p >= Ins->Words.size()) {
+					if (p >= Ins->Words.size() && Ins->DecData->Record.size()) {
+						BaseValue = RecordValue(Ins->ScopeData->Record(Ins->DecData->Record));
+					} else if (p >= Ins->Words.size()) {
 						switch (Ins->DecData->Type) {
 						case VarType::Boolean:
 							BaseValue = "false"; break;
@@ -2278,16 +2977,35 @@ public:
 					// Static Local
 					if (Ins->DecData->IsStatic) {
 						//TransError("Static locals not yet supported");
-						static size_t count{ 0 };
 						auto
-							stname{ TrSPrintF("Static_%08x",count++) },
+							stname{ TrSPrintF("Static_%08x",Ret.Count("Static")) },
 							fullstname{ StaticRegister + "_" + stname };
+						if (ChunkLocals < MaxChunkLocals) {
+							// A default value or a literal is just set when the chunk is loaded, so the function itself doesn't have to do anything.
+							// Anything else may depend on the function's arguments, or on classes not registered yet at load time.
+							// Those start out as the static register itself, which can never be a value set by the script, and get their value the first time they are passed.
+							auto Lit{ p >= Ins->Words.size() };
+							if (!Lit) {
+								auto LW{ Ins->Words[Ins->Words.size() - 1] };
+								auto Single{ p == Ins->Words.size() - 1 || (p == Ins->Words.size() - 2 && Ins->Words[p]->TheWord == "-" && LW->Kind == WordKind::Number) };
+								Lit = Single && (LW->Kind == WordKind::String || LW->Kind == WordKind::Number || LW->UpWord == "TRUE" || LW->UpWord == "FALSE" || LW->UpWord == "NIL");
+							}
+							ChunkLocals++;
+							StaticLocals += "; local " + fullstname + " = " + (Lit ? BaseValue : StaticRegister);
+							if (!Lit) *Trans += "if " + fullstname + " == " + StaticRegister + " then " + fullstname + " = " + BaseValue + " end";
+							*Trans += "\n";
+							(*Ins->ScopeData->LocalVars)[VarName] = fullstname;
+							if (Ins->DecData->Record.size()) Ins->ScopeData->RecordVars[VarName] = Ins->DecData->Record;
+							Ins->ScopeData->LocalDeclaLine[VarName] = Ins->LineNumber;
+							break;
+						}
 						//*Trans += TrSPrintF("if not %s[\"%s\"] then ", StaticRegister.c_str(), stname.c_str());
 						*Trans += "if not "+StaticRegister+"[\""+stname+"\"] then ";
 						// Static Locals!
 						//if (Ins->DecData->Type == VarType::pLua) {
 							*Trans += TrSPrintF("%s = %s; ", fullstname.c_str(), BaseValue.c_str());
 							(*Ins->ScopeData->LocalVars)[VarName] = fullstname;
+							if (Ins->DecData->Record.size()) Ins->ScopeData->RecordVars[VarName] = Ins->DecData->Record;
 						/* } else {
 							auto ReadOnly{ Lower(boolstring(Ins->DecData->IsReadOnly || Ins->DecData->IsConstant)) };
 							*Trans += TrSPrintF("Scyndi.ADDMBER(\"..GLOBALS..\", \"%s\", \"%s\", false, %s, %s, value);", _Declaration::E2S(Ins->DecData->Type).c_str(), fullstname.c_str(), ReadOnly.c_str(), ReadOnly.c_str(), BaseValue.c_str());
@@ -2307,8 +3025,7 @@ public:
 						Ins->ScopeData->LocalDeclaLine[VarName] = Ins->LineNumber;
 					} else {
 						if (!Ins->ScopeData->ScopeLoc.size()) {
-							static size_t count{ 0 };
-							Ins->ScopeData->ScopeLoc = TrSPrintF("__ScyndiLocals_%08x_%02d_", count++, (int)Ins->ScopeData->Kind);
+							Ins->ScopeData->ScopeLoc = TrSPrintF("__ScyndiLocals_%08x_%02d_", Ret.Count("Locals"), (int)Ins->ScopeData->Kind);
 							Ins->ScopeData->ScopeLoc += md5(Ins->ScopeData->ScopeLoc + srcfile);
 							*Trans += "local " + Ins->ScopeData->ScopeLoc + " = Scyndi.CreateLocals(); ";
 						}
@@ -2317,6 +3034,7 @@ public:
 						(*Ins->ScopeData->LocalVars)[VarName] = Ins->ScopeData->ScopeLoc+"[\""+VarName+"\"]"; //TrSPrintF("%s[\"%s\"]", Ins->ScopeData->ScopeLoc.c_str(), VarName.c_str());
 						Ins->ScopeData->LocalDeclaLine[VarName] = Ins->LineNumber;
 					}
+					if (Ins->DecData->Record.size()) Ins->ScopeData->RecordVars[VarName] = Ins->DecData->Record;
 					*Trans += "\n";
 				}
 				break;
@@ -2344,18 +3062,16 @@ public:
 				if (dec->IsGlobal) fclass = "..GLOBALS..";
 				if (dec->IsRoot) fclass = ScriptName;
 				TransAssert(fclass.size(), "GET property not possible as a local");
+				TransAssert(Ret.ClassDesc(fclass), "Internal error! No descriptor for class " + fclass);
 				//*Trans += TrSPrintF("Scyndi.ADDPROPERTY(\"%s\", \"%s\", %s, \"get\", function(self) \n", fclass.c_str(),VarName.c_str(),lboolstring(dec->IsStatic || dec->IsRoot || dec->IsGlobal).c_str());
-				*Trans += "Scyndi.ADDPROPERTY(\""+fclass+"\", \""+VarName+"\", "+lboolstring(dec->IsStatic || dec->IsRoot || dec->IsGlobal)+", \"get\", function(self) \n";
+				*Trans += "rawset(" + Ret.ClassDesc(fclass)->Local + ((dec->IsStatic || dec->IsRoot || dec->IsGlobal) ? ".StaticGet" : ".Get") + ", \"" + VarName + "\", function(self) \n";
 				if (debug) *Trans += TrSPrintF("Scyndi.Debug.Push(\"Property(GET) %s.%s\") ",fclass.c_str(),VarName.c_str());
 				if (Ins->DecData->BoundToClass.size() && (!Ins->DecData->IsStatic)) {
 					(*Ins->NextScope->LocalVars)["self"] = "self";
-					for (auto& FLD : Ret.Fields[Upper(Ins->DecData->BoundToClass)]) {
-						(*Ins->NextScope->LocalVars)[FLD] = TrSPrintF("self.%s", FLD.c_str());
-					}
+					Ret.MapFields(Ins->NextScope, Ins->DecData->BoundToClass);
 				}
 			} break;
 			case InsKind::PropertySet: {
-				static size_t count{ 0 };
 				auto dec{ Ins->DecData };
 				auto fclass{ dec->BoundToClass };
 				auto VarName{ Ins->Words[Ins->ForEachExpression]->UpWord };
@@ -2363,30 +3079,29 @@ public:
 				if (dec->IsGlobal) fclass = "..GLOBALS..";
 				if (dec->IsRoot) fclass = ScriptName;
 				TransAssert(fclass.size(), "GET property not possible as a local");
-				Ins->NextScope->ScopeLoc = TrSPrintF("Scyndi_Set_Property_%08x_%s", count++, md5(VarName).c_str());
+				Ins->NextScope->ScopeLoc = TrSPrintF("Scyndi_Set_Property_%08x_%s", Ret.Count("PropertySet"), md5(srcfile + VarName).c_str()); // Not a local, so the file name must keep it apart from the other translations
+				TransAssert(Ret.ClassDesc(fclass), "Internal error! No descriptor for class " + fclass);
 				//*Trans += TrSPrintF("Scyndi.ADDPROPERTY(\"%s\", \"%s\", %s, \"set\", function(self,_value) \n", fclass.c_str(), VarName.c_str(), lboolstring(dec->IsStatic || dec->IsRoot || dec->IsGlobal));
-				*Trans += "Scyndi.ADDPROPERTY(\""+fclass+"\", \""+VarName+"\", "+lboolstring(dec->IsStatic || dec->IsRoot || dec->IsGlobal)+", \"set\", function(self,_value) \n";
+				*Trans += "rawset(" + Ret.ClassDesc(fclass)->Local + ((dec->IsStatic || dec->IsRoot || dec->IsGlobal) ? ".StaticSet" : ".Set") + ", \"" + VarName + "\", function(self,_value) \n";
 				if (debug) *Trans += TrSPrintF("Scyndi.Debug.Push(\"Property(SET) %s.%s\") ", fclass.c_str(), VarName.c_str());
 				*Trans += Ins->NextScope->ScopeLoc; *Trans += " = Scyndi.CreateLocals()\n";
 				//*Trans += TrSPrintF("Scyndi.DECLARELOCAL(%s,\"%s\", false,\"Value\",_value); ", Ins->NextScope->ScopeLoc.c_str(), _Declaration::E2S(Ins->DecData->Type).c_str());
 				*Trans += "Scyndi.DECLARELOCAL("+Ins->NextScope->ScopeLoc+", \""+_Declaration::E2S(Ins->DecData->Type)+"\",false,\"Value\",_value); ";
 				(*Ins->NextScope->LocalVars)["VALUE"] = Ins->NextScope->ScopeLoc+"[\"VALUE\"]";
 				if (Ins->DecData->BoundToClass.size() && (!Ins->DecData->IsStatic)) {
-					for (auto& FLD : Ret.Fields[Upper(Ins->DecData->BoundToClass)]) {
-						(*Ins->NextScope->LocalVars)["self"] = "self";
-						(*Ins->NextScope->LocalVars)[FLD] = TrSPrintF("self.%s", FLD.c_str());
-					}
+					(*Ins->NextScope->LocalVars)["self"] = "self";
+					Ret.MapFields(Ins->NextScope, Ins->DecData->BoundToClass);
 				}
 			} break;
 			case InsKind::StartMethod:
 			case InsKind::DefineFunction: {
 				TransAssert(Ins->DecData, "No DecData in translation (transphase/function) - This is an internal error! Please report!");
-				static size_t count = 0;
+				auto count{ Ret.Count("Function") };
 				auto FNamePos{ Ins->ForEachExpression };
 				auto FName{ Ins->Words[FNamePos] };
 				auto Arg1Pos{ FNamePos + 2 };
 				auto Ending{ Ins->Words.size() };
-				auto ScN{ TrSPrintF("ScyndiFuncScope_%08X_",count++) + FName->TheWord + md5(FName->TheWord + std::to_string(count)).c_str() };
+				auto ScN{ TrSPrintF("ScyndiFuncScope_%08X_",count) + FName->TheWord + md5(FName->TheWord + std::to_string(count + 1)).c_str() };
 				auto VarName{ FName->UpWord };
 				auto PluaName{ FName->TheWord };
 				std::string Prefix{ "" }; if (TransConfig.count("PLUAPREFIX")) Prefix = TransConfig["PLUAPREFIX"]->TheWord;
@@ -2500,6 +3215,16 @@ public:
 						Args.push_back(A);
 						TransAssert(Pos < Ending && (Ins->Words[Pos]->Kind == WordKind::Comma || Ins->Words[Pos]->TheWord == ")"), TrSPrintF("Syntax error in function defintion after (boolean) argument #%d", Args.size())+" ("+ Ins->Words[Pos]->TheWord+")");
 						Pos++;
+					} else if (Ins->Words[Pos]->TheWord[0] == '@' && oscope->Record(Ins->Words[Pos]->UpWord.substr(1))) {
+						auto Rec{ Ins->Words[Pos]->UpWord.substr(1) };
+						Pos++;
+						TransAssert(Pos < Ending && Ins->Words[Pos]->Kind == WordKind::Identifier, "Identifier expected for record argument");
+						Arg A{ Ins->Words[Pos]->UpWord, ScN + "[\"" + Ins->Words[Pos]->UpWord + "\"]", "", VarType::Table, false, Rec };
+						if (ArgLine.size()) ArgLine += ", "; ArgLine += TrSPrintF("Arg%d", Args.size());
+						Args.push_back(A);
+						Pos++;
+						TransAssert(Pos < Ending && (Ins->Words[Pos]->Kind == WordKind::Comma || Ins->Words[Pos]->TheWord == ")"), TrSPrintF("Syntax error in function definition after (record) argument #%d", Args.size()));
+						Pos++;
 					} else if (Ins->Words[Pos]->TheWord[0] == '@') {
 						TransError("Custom class type as function argument not (yet) supported. Just use an untyped argument or a pLua in stead");
 					} else if (Ins->Words[Pos]->UpWord == "DELEGATE" || Ins->Words[Pos]->UpWord == "TABLE" || Ins->Words[Pos]->UpWord == "BOOL") {
@@ -2526,17 +3251,22 @@ public:
 				}
 				switch (oscope->Kind) {
 				case ScopeKind::Class:
-				case ScopeKind::Group:
+				case ScopeKind::Group: {
+					auto Err{ DescName(Ins->DecData->BoundToClass, VarName, Ins->DecData->IsStatic ? "function" : "method") };
+					TransAssert(!Err.size(), Err);
+					auto D{ Ret.ClassDesc(Ins->DecData->BoundToClass) };
 					if (Ins->DecData->IsStatic) {
-						*Trans += TrSPrintF("Scyndi.ADDMBER(\"%s\",\"DELEGATE\",\"%s\",true,true,true,function (%s) ", Ins->DecData->BoundToClass.c_str(), VarName.c_str(), ArgLine.c_str());
+						*Trans += TrSPrintF("rawset(%s.Functions, \"%s\", function (%s) ", D->Local.c_str(), VarName.c_str(), ArgLine.c_str());
 						//(*Ins->NextScope->LocalVars)["SELF"] = "Scyndi.Class[\"" + Ins->DecData->BoundToClass + "\"]";
 						*Trans += "local self = Scyndi.Class[\"" + Ins->DecData->BoundToClass + "\"]\t";
-					} else if (ArgLine.size())
-						*Trans += TrSPrintF("Scyndi.ADDMETHOD(\"%s\", \"%s\", %s, function(self,%s)", Ins->DecData->BoundToClass.c_str(), VarName.c_str(), lboolstring(Ins->DecData->IsFinal).c_str(), ArgLine.c_str());
-					else {
-						*Trans += TrSPrintF("Scyndi.ADDMETHOD(\"%s\", \"%s\", %s, function(self)", Ins->DecData->BoundToClass.c_str(), VarName.c_str(), lboolstring(Ins->DecData->IsFinal).c_str());
+					} else {
+						if (Ins->DecData->IsFinal) *Trans += D->Local + ".Finals[\"" + VarName + "\"] = true; ";
+						if (ArgLine.size())
+							*Trans += TrSPrintF("rawset(%s.Methods, \"%s\", function(self,%s)", D->Local.c_str(), VarName.c_str(), ArgLine.c_str());
+						else
+							*Trans += TrSPrintF("rawset(%s.Methods, \"%s\", function(self)", D->Local.c_str(), VarName.c_str());
 					}
-					break;
+				} break;
 				case ScopeKind::Root:
 					if (Ins->DecData->IsGlobal) {
 						if (Ins->DecData->Type == VarType::pLua) {
@@ -2548,7 +3278,9 @@ public:
 							*Trans += "function " + ref + "(" + ArgLine + ") ";
 
 						} else {
-							*Trans += TrSPrintF("Scyndi.ADDMBER(\"..GLOBALS..\",\"DELEGATE\",\"%s\",true,true,true,function (%s) ", VarName.c_str(), ArgLine.c_str());
+							auto Err{ DescName("..GLOBALS..", VarName, "function") };
+							TransAssert(!Err.size(), Err);
+							*Trans += TrSPrintF("rawset(%s.Functions, \"%s\", function (%s) ", Ret.ClassDesc("..GLOBALS..")->Local.c_str(), VarName.c_str(), ArgLine.c_str());
 							//auto ref{ TrSPrintF("Scyndi.Globals[\"%s\"]",VarName.c_str()) };
 							//Ret.Trans->Data->Add("Globals", "-list-", VarName);
 							//Ret.Trans->Data->Value("Globals", VarName, ref);
@@ -2561,7 +3293,9 @@ public:
 							//(*Ret.RootScope->LocalVars)[VarName] = ref;
 							*Trans += ref + "= function(" + ArgLine + ") ";
 						} else {
-							*Trans += TrSPrintF("Scyndi.ADDMBER(\"%s\",\"DELEGATE\",\"%s\",true,true,true,function (%s) ", ScriptName.c_str(), VarName.c_str(), ArgLine.c_str());
+							auto Err{ DescName(ScriptName, VarName, "function") };
+							TransAssert(!Err.size(), Err);
+							*Trans += TrSPrintF("rawset(%s.Functions, \"%s\", function (%s) ", Ret.ClassDesc(ScriptName)->Local.c_str(), VarName.c_str(), ArgLine.c_str());
 							//auto ref{ TrSPrintF("Scyndi.Class[\"%s\"][\"%s\"]",ScriptName.c_str(),VarName.c_str()) };
 							//(*Ret.RootScope->LocalVars)[VarName] = ref;
 						}
@@ -2604,7 +3338,8 @@ public:
 							break;
 						default:
 							if (Ag->HasBaseValue) TransError("Base value not permitted for that type");
-							IValue = "nil";
+							// Like a variable, a record argument without a value gets a fresh record with the defaults
+							IValue = Ag->Record.size() ? RecordValue(oscope->Record(Ag->Record)) : "nil";
 							break;
 						}
 						//*Trans += TrSPrintF("Scyndi.DECLARELOCAL(%s,\"%s\", false,\"%s\",Arg%d or %s); ", Ins->NextScope->ScopeLoc.c_str(), _Declaration::E2S(Args[ap].dType).c_str(), Args[ap].Name.c_str(), ap, IValue.c_str());
@@ -2618,6 +3353,7 @@ public:
                             IValue +
                             ");  ";
 						(*Ins->NextScope->LocalVars)[Upper(Ag->Name)] = Ins->NextScope->ScopeLoc+"[\""+Ag->Name+"\"]"; //TrSPrintF("%s[\"%s\"]", Ins->NextScope->ScopeLoc.c_str(), Ag->Name.c_str());
+						if (Ag->Record.size()) Ins->NextScope->RecordVars[Upper(Ag->Name)] = Ag->Record;
 					}
 				}
 				*Trans += pLuaLine;
@@ -2625,9 +3361,7 @@ public:
 				if (Ins->Kind == InsKind::StartMethod) {
 					(*Ins->NextScope->LocalVars)["SELF"] = "self";
 					//std::cout << "Fields for "<< Upper(Ins->DecData->BoundToClass)<<"\n";
-					for (auto& FLD : Ret.Fields[Upper(Ins->DecData->BoundToClass)]) {
-						(*Ins->NextScope->LocalVars)[FLD] = TrSPrintF("self.%s", FLD.c_str());
-					}
+					Ret.MapFields(Ins->NextScope, Ins->DecData->BoundToClass);
 				}
 				//TransError("Function defs not yet complete"); // security
 			} break;
@@ -2641,13 +3375,12 @@ public:
                         TransAssert(Ins->Words[1]->Kind==WordKind::Identifier,"Syntax error in short abstract definition! Identifier expected");
                         //TransAssert(Ins->DecData->BoundToClass.size(),"Abstract without class");
                         TransAssert(Ins->ScopeData->ClassID.size(),"Abstract without class");
+                        auto Err{ DescName(Ins->ScopeData->ClassID, Ins->Words[1]->UpWord, "abstract") };
+                        TransAssert(!Err.size(), Err);
                         // _Scyndi.ADDABSTRACT(ch,dtype,_name)
-                        *Trans += "Scyndi.ADDABSTRACT(\"";
-                        //*Trans += Ins->DecData->BoundToClass;
-                        *Trans += Ins->ScopeData->ClassID;
-                        *Trans += "\", \"VAR\", \"";
-                        *Trans += Ins->Words[1]->UpWord;
-                        *Trans += "\")\n";
+                        *Trans += Ret.ClassDesc(Ins->ScopeData->ClassID)->Local;
+                        *Trans += ".Abstracts[\"" + Ins->Words[1]->UpWord + "\"]";
+                        *Trans += " = \"VAR\"\n";
                     } break;
                     default: {
                         TVV("Abstract - Long");
@@ -2666,15 +3399,15 @@ public:
                         TransAssert(Ins->ScopeData->ClassID.size(),"Abstract without class");
                         //std::cout<<"Updating *Trans\n";
                         //TransAssert(Trans,"Internal error on abstract translation (Trans = null)");
-                        *Trans += "Scyndi.ADDABSTRACT(\"";
+                        auto Err{ DescName(Ins->ScopeData->ClassID, Ins->Words[idp]->UpWord, "abstract") };
+                        TransAssert(!Err.size(), Err);
                         //std::cout << "Bound to class: ";
                         //TransAssert(Ins->DecData,"Internal error on abstract translation (DecData = null)");
-                        *Trans += Ins->ScopeData->ClassID;
+                        *Trans += Ret.ClassDesc(Ins->ScopeData->ClassID)->Local;
                         //std::cout<<*Trans<<"***End Of *Trans\n";
                         //std::cout<<Ins->DecData->BoundToClass<<"\n";
-                        *Trans += "\", \"VAR\", \""; // Normally the type goes here, but at the present time Scyndi Core ignores that anyway.
-                        *Trans += Ins->Words[idp]->UpWord;
-                        *Trans += "\")\n";
+                        *Trans += ".Abstracts[\"" + Ins->Words[idp]->UpWord + "\"]";
+                        *Trans += " = \"VAR\"\n"; // Normally the type goes here, but at the present time Scyndi Core ignores that anyway.
                         //std::cout<<"Done! Next, please\n";
                     } break;
                 } break;
@@ -2722,7 +3455,7 @@ public:
 			case InsKind::FallThrough:
 				break; // No more purpose at this point!
 			case InsKind::Case: {
-				static std::map<std::string, size_t> CaseCount{};
+				auto& CaseCount{ Ret.CaseCount };
 				if (!CaseCount.count(*Ins->SwitchName)) CaseCount[*Ins->SwitchName] = 0;
 				if (CaseCount[*Ins->SwitchName]) {
 					if (!(Ins->ScopeData->caseFallThrough || Ins->ScopeData->DidReturn)) *Trans += "goto " + *Ins->SwitchName + "_End;\t";
@@ -2760,9 +3493,8 @@ public:
 				break;
 			case InsKind::Return: {
 				DbgLineCheck;
-				if (Ins->Scope != ScopeKind::Defer) *Trans += Ins->ScopeData->DeferLine();
+				*Trans += Ins->ScopeData->DeferLine();
 				if (debug) *Trans += " Scyndi.Debug.Pop(); ";
-				// TODO: If there are any defers, take care of them first!
 				auto Sc{ Ins->ScopeData };
 				auto fKind{ Sc->FunctionScopeType() };
 				if (fKind == VarType::Void) {
@@ -2774,6 +3506,13 @@ public:
 				TransAssert(Ins->Words.size() > 1, "Return without data");
 				auto Ex{ Expression(Ret.Trans,Ins,1) };
 				if (!Ex) return nullptr;
+				if (InlineReturns.count(Ins.get())) {
+					auto Def{ InlineReturns[Ins.get()] };
+					auto Quick{ Def->Kind == InsKind::QFuncDef };
+					auto Name{ Quick ? Def->Words[1]->TheWord : Def->Words[Def->ForEachExpression]->TheWord };
+					auto Why{ Quick ? QuickInline(Ins, Def, *Ex) : FuncInline(Ins, Def, *Ex) };
+					if (Why.size()) Verb("Not inlined", Name + " (" + Why + ")"); else Verb("Inlining", Name);
+				}
 				*Trans += "return ";
 				switch (fKind) {
 				case VarType::CustomClass:
@@ -2824,14 +3563,15 @@ public:
 				Sc->DidReturn = true;
 				*Trans += "\n";
 			} break;
-			case InsKind::Defer: {
-				static size_t DeferCount{ 0 };
-				if (!Ins->ScopeData->DeferID.size()) {
-					Ins->ScopeData->DeferID = TrSPrintF("Scyndi_Defer_%08x_%s", DeferCount++, md5(srcfile + std::to_string(Ins->LineNumber)).c_str());
-					*Trans += "local " + Ins->ScopeData->DeferID + " = {}\t";
-				}
-				*Trans += Ins->ScopeData->DeferID + "[ #" + Ins->ScopeData->DeferID + " + 1 ] = function()\n";
-			} break;
+			case InsKind::Defer:
+				// Nothing is put out here. The block is translated into DeferCode, and DeferLine puts it at every exit of the function.
+				TransAssert(!DeferMain, "DEFER in DEFER (internal error! Please report!)");
+				MapLine(nullptr);
+				DeferMain = Trans;
+				DeferCode = "";
+				DeferTarget = Ins->ScopeData.get();
+				Trans = &DeferCode;
+				break;
 			case InsKind::Break:
 				*Trans += "break\n";
 				break;
@@ -2844,17 +3584,21 @@ public:
 				//break;
 			}
 		}
+		MapLine(nullptr);
+		Trans->insert(StaticHoist, StaticLocals);
 #pragma endregion
 
 #pragma region "Last closure stuff added to the translation"
 		*Trans += "\n\n";
-		for (auto& Seal : ToSeal) *Trans += "Scyndi.Seal(\"" + Seal + "\");\n";
+		*Trans += "Scyndi.RegisterClasses(" + ClassDescs + ")\n";
 		if (HasInit) {
 			*Trans += "\n\nfor _,ifunc in ipairs(" + InitTag + ") do ifunc() end; " + InitTag + " = nil";
 		}
 		Ret.Trans->Data->Value("Translation", "Target", "Lua");
 		Ret.Trans->Data->Value("Translation", "Origin", "Scyndi");
 		Ret.Trans->Data->Value("Translation", "Debug", boolstring(debug));
+		Ret.Trans->Data->Value("Translation", "LineCalls", boolstring(LineCalls));
+		Ret.Trans->Data->Value("Translation", "Inline", std::to_string(Budget));
 		for (auto M : Macros) Ret.Trans->Data->Value("Macros", M.first, M.second);
 #pragma endregion
 		return Ret.Trans;
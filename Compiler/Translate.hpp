@@ -29,10 +29,12 @@
 #include <SlyvGINIE.hpp>
 #include <SlyvTime.hpp>
 #include <JCR6_Core.hpp>
+#include "LineMap.hpp"
 
 namespace Scyndi {
 
 	extern bool TransVerbose;
+	extern bool TransDeterministic; // When set, identical sources always give identical translations (no dates and times in generated names)
 
 	enum class ScriptKind { Unknown, Script, Module };
 
@@ -59,15 +61,41 @@ namespace Scyndi {
 			JCRIncludes{ Slyvina::NewVecString() };
 		Slyvina::Units::GINIE
 			Data{ Slyvina::Units::ParseGINIE("[Create]\nData=" + Slyvina::Units::CurrentDate()) };
+		LineMap
+			Lines{ nullptr }; // Lua line => Scyndi file and line
 	};
 	typedef std::shared_ptr<_Translation> Translation;
 
+	/// <summary>
+	/// What the translator read for other scripts, kept so it doesn't have to read it again.
+	/// Imports: by upper case entry name of a script, the globals and macros a #USE request of it brings (and their interface digest).
+	/// Includes: by file name as written in the #INCLUDE request, the lines read from it (which are chopped again every time, as the macros may differ).
+	/// Only the watch mode keeps these. It's up to the keeper to throw away what has changed.
+	/// </summary>
+	struct _TransImport { std::map<std::string, std::string> Globals{}, Macros{}; std::string Interface{ "" }; };
+	typedef std::shared_ptr<_TransImport> TransImport;
+	struct _TransCache { std::map<std::string, TransImport> Imports{}; std::map<std::string, Slyvina::VecString> Includes{}; };
+	typedef std::shared_ptr<_TransCache> TransCache;
+	extern TransCache TransKept; // nullptr when nothing is kept
+
 	/// <summary>
 	/// Returns an empty string if the last translation was succesful, otherwise it will return the error message
 	/// </summary>
 	/// <returns></returns>
 	std::string TranslationError();
 
+	/// <summary>
+	/// Debug builds used to call Scyndi.Debug.Line before nearly every statement. The line maps made that obsolete, as errors can be traced back with those (Scyndi.MapTrace).
+	/// Hosts that depend on those calls can still have them with LineCalls=TRUE in the [Debug] section of the project file.
+	/// </summary>
+	bool DebugLineCalls(Slyvina::Units::GINIE PrjData, bool debug);
+
+	/// <summary>
+	/// Calls to DDEF quick functions which are only a RETURN can be replaced by the expression itself. This is the maximum number of words such an expression may have.
+	/// Set with Inline in the [Translation] section of the project file (a number, TRUE for the default of 32, or FALSE). Debug builds never inline.
+	/// </summary>
+	size_t InlineBudget(Slyvina::Units::GINIE PrjData, bool debug);
+
 
 	Translation Translate(Slyvina::VecString sourcelines, std::string srcfile = "", Slyvina::JCR6::JT_Dir JD = nullptr, Slyvina::Units::GINIE D = nullptr, bool debug = false, bool force = false);
 	Translation Translate(std::string source, std::string srcfile = "", Slyvina::JCR6::JT_Dir JD = nullptr, Slyvina::Units::GINIE D=nullptr, bool debug = false, bool force=false);
@@ -0,0 +1,258 @@
+// License:
+// 
+// Scyndi
+// Watch mode
+// 
+// 
+// 
+// 	(c) Jeroen P. Broks, 2026
+// 
+// 		This program is free software: you can redistribute it and/or modify
+// 		it under the terms of the GNU General Public License as published by
+// 		the Free Software Foundation, either version 3 of the License, or
+// 		(at your option) any later version.
+// 
+// 		This program is distributed in the hope that it will be useful,
+// 		but WITHOUT ANY WARRANTY; without even the implied warranty of
+// 		MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// 		GNU General Public License for more details.
+// 		You should have received a copy of the GNU General Public License
+// 		along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// 
+// 	Please note that some references to data like pictures or audio, do not automatically
+// 	fall under this licenses. Mostly this is noted in the respective files.
+// 
+// Version: 26.10.19
+// End License
+
+#include <filesystem>
+#include <chrono>
+#include <thread>
+#include <set>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <poll.h>
+#endif
+
+#include <SlyvString.hpp>
+#include <SlyvQCol.hpp>
+#include <SlyvTime.hpp>
+#include <SlyvGINIE.hpp>
+
+#include <JCR6_Core.hpp>
+
+#include "Watch.hpp"
+#include "ScyndiProject.hpp"
+#include "Translate.hpp"
+#include "Link.hpp"
+
+using namespace Slyvina;
+using namespace Slyvina::Units;
+using namespace Slyvina::JCR6;
+namespace fs = std::filesystem;
+
+namespace Scyndi {
+
+	static std::string NormPath(std::string P) {
+		std::error_code ec;
+		auto A{ fs::absolute(fs::path(P), ec) };
+		if (ec) return fs::path(P).lexically_normal().generic_string();
+		return A.lexically_normal().generic_string();
+	}
+
+#pragma region "Watcher"
+#ifdef __linux__
+	class _Watcher {
+	private:
+		int fd{ -1 };
+		std::map<int, std::string> Dirs{};
+		void AddOne(std::string Dir) {
+			auto wd{ inotify_add_watch(fd, Dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE) };
+			if (wd >= 0) Dirs[wd] = Dir;
+		}
+	public:
+		_Watcher() { fd = inotify_init1(IN_NONBLOCK); if (fd < 0) QCol->Error("inotify could not be initialized"); }
+		~_Watcher() { if (fd >= 0) close(fd); }
+		void Add(std::string Dir) {
+			std::error_code ec;
+			if (fd < 0 || !fs::is_directory(Dir, ec)) return;
+			AddOne(Dir);
+			for (auto E{ fs::recursive_directory_iterator(Dir, ec) }; (!ec) && E != fs::recursive_directory_iterator(); E.increment(ec)) {
+				if (E->is_directory(ec)) AddOne(E->path().string());
+			}
+		}
+		// Blocks until something changed. Events arriving shortly after each other are taken together, as editors tend to save in several steps.
+		void Wait(std::vector<std::string>& Changed, bool& Structural) {
+			auto Got{ false };
+			while (fd >= 0) {
+				pollfd P{ fd, POLLIN, 0 };
+				auto r{ poll(&P, 1, Got ? 30 : -1) };
+				if (r <= 0) { if (Got) return; continue; }
+				alignas(inotify_event) char buf[16384];
+				auto len{ read(fd, buf, sizeof(buf)) };
+				if (len <= 0) continue;
+				for (char* p = buf; p < buf + len; ) {
+					auto ev{ (inotify_event*)p };
+					p += sizeof(inotify_event) + ev->len;
+					if ((!Dirs.count(ev->wd)) || (!ev->len)) continue;
+					auto Path{ Dirs[ev->wd] + "/" + ev->name };
+					if (ev->mask & (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)) Structural = true;
+					if ((ev->mask & IN_CREATE) && (ev->mask & IN_ISDIR)) Add(Path);
+					Changed.push_back(Path);
+					Got = true;
+				}
+			}
+		}
+	};
+#else
+	// No change notifications supported here (yet), so just poll the time stamps and sizes of the files.
+	class _Watcher {
+	private:
+		typedef std::map<std::string, std::pair<fs::file_time_type, uintmax_t>> Snap;
+		std::vector<std::string> Roots{};
+		Snap Seen{};
+		void Snapshot(std::string Dir, Snap& S) {
+			std::error_code ec;
+			for (auto E{ fs::recursive_directory_iterator(Dir, ec) }; (!ec) && E != fs::recursive_directory_iterator(); E.increment(ec)) {
+				if (E->is_regular_file(ec)) S[E->path().string()] = { E->last_write_time(ec), E->file_size(ec) };
+			}
+		}
+	public:
+		void Add(std::string Dir) { Roots.push_back(Dir); Snapshot(Dir, Seen); }
+		void Wait(std::vector<std::string>& Changed, bool& Structural) {
+			while (true) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(250));
+				Snap Now{};
+				for (auto& R : Roots) Snapshot(R, Now);
+				for (auto& N : Now) {
+					if (!Seen.count(N.first)) { Structural = true; Changed.push_back(N.first); } 
+					else if (Seen[N.first] != N.second) Changed.push_back(N.first);
+				}
+				for (auto& S : Seen) if (!Now.count(S.first)) { Structural = true; Changed.push_back(S.first); }
+				Seen = Now;
+				if (Changed.size()) return;
+			}
+		}
+	};
+#endif
+#pragma endregion
+
+#pragma region "Dependency graph"
+	// Keys are normalized real paths, or upper case entry names. Values are the entries of the scripts to rebuild when the key changes.
+	static std::map<std::string, std::set<std::string>> Dependents{};
+	static std::map<std::string, std::string> FileToEntry{};
+
+	// The edges of a script go first, so the dependencies and includes it no longer has, don't keep rebuilding it.
+	static void MapEntry(ProjectModel M, std::string Entry, bool debug) {
+		for (auto D{ Dependents.begin() }; D != Dependents.end(); ) {
+			D->second.erase(Entry);
+			if (D->second.empty()) D = Dependents.erase(D); else ++D;
+		}
+		auto Cfg{ STBConfig(STBFile(M->Res->Entry(Entry)->MainFile, debug)) };
+		if (!Cfg) return;
+		for (auto& D : *Cfg->List("Build", "Dependencies")) Dependents[Upper(D + ".Scyndi")].insert(Entry);
+		for (auto& I : *Cfg->List("Build", "RealIncludes")) Dependents[NormPath(I)].insert(Entry);
+		for (auto& I : *Cfg->List("Build", "JCRIncludes")) Dependents[Upper(I)].insert(Entry);
+	}
+
+	static void MapProject(ProjectModel M, bool debug) {
+		Dependents.clear();
+		FileToEntry.clear();
+		auto Entries{ M->Res->Entries() };
+		for (auto& E : *Entries) FileToEntry[NormPath(E->MainFile)] = E->Name();
+		for (auto& E : *Entries) if (Upper(ExtractExt(E->Name())) == "SCYNDI") MapEntry(M, E->Name(), debug);
+	}
+
+	// What the translator kept of a script goes when it's dirty, and that of an include when it's changed (Keys as in Dependents).
+	static void ForgetKept(ProjectModel M, std::map<std::string, std::string>& Dirty, std::set<std::string>& Keys) {
+		for (auto& D : Dirty) M->Kept->Imports.erase(D.first);
+		for (auto I{ M->Kept->Includes.begin() }; I != M->Kept->Includes.end(); ) {
+			if (Keys.count(NormPath(I->first)) || Keys.count(Upper(I->first))) I = M->Kept->Includes.erase(I); else ++I;
+		}
+	}
+
+	// Real includes outside the project live in directories of their own, which have to be watched too. Any script can start including from a new one.
+	static void WatchIncludes(_Watcher& W, std::set<std::string>& IncDirs) {
+		for (auto& D : Dependents) {
+			if (FileToEntry.count(D.first) || !fs::path(D.first).is_absolute()) continue;
+			auto Dir{ fs::path(D.first).parent_path().string() };
+			if (IncDirs.count(Dir)) continue;
+			IncDirs.insert(Dir);
+			W.Add(Dir);
+		}
+	}
+#pragma endregion
+
+	Slyvina::uint64 WatchProject(std::string prj, bool force, bool debug) {
+		TransVerbose = true;
+		auto M{ LoadProject(prj) };
+		if (!M) return 1;
+		M->Kept = std::make_shared<_TransCache>();
+		TransKept = M->Kept;
+		BuildProject(M, force, debug);
+		TransVerbose = false;
+		MapProject(M, debug);
+		_Watcher W{};
+		for (auto& D : *M->Dirs) W.Add(D);
+		for (auto& D : *M->Libs) W.Add(D);
+		std::set<std::string> IncDirs{};
+		WatchIncludes(W, IncDirs);
+		QCol->LGreen("Watching for changes. Press Ctrl-C to stop.\n");
+		while (true) {
+			std::vector<std::string> Changed{};
+			auto Structural{ false };
+			W.Wait(Changed, Structural);
+			auto Start{ std::chrono::steady_clock::now() };
+			// New, removed or renamed scripts require the directories to be read again. Anything else (like saving an STB) does not.
+			auto Rescan{ false };
+			for (auto& P : Changed) Rescan = Rescan || (Structural && Upper(ExtractExt(P)) == "SCYNDI");
+			if (Rescan) {
+				if (!ScanProject(M)) continue;
+				*M->Kept = _TransCache{}; // Scripts may be gone, or be found somewhere else now
+				MapProject(M, debug);
+				WatchIncludes(W, IncDirs);
+			}
+			std::map<std::string, std::string> Dirty{}; // Upper case entry name => entry name
+			std::vector<std::string> Todo{};
+			for (auto& P : Changed) {
+				auto N{ NormPath(P) };
+				Todo.push_back(N);
+				if (FileToEntry.count(N)) {
+					auto E{ FileToEntry[N] };
+					Todo.push_back(Upper(E));
+					if (Upper(ExtractExt(E)) == "SCYNDI") Dirty[Upper(E)] = E;
+				}
+			}
+			std::set<std::string> Keys(Todo.begin(), Todo.end());
+			while (Todo.size()) {
+				auto K{ Todo.back() }; Todo.pop_back();
+				if (!Dependents.count(K)) continue;
+				for (auto& D : Dependents[K]) {
+					if (Dirty.count(Upper(D))) continue;
+					Dirty[Upper(D)] = D;
+					Todo.push_back(Upper(D));
+				}
+			}
+			ForgetKept(M, Dirty, Keys);
+			if (!Dirty.size()) continue;
+			for (auto& D : Dirty) if (M->Res->EntryExists(D.second)) ForgetVerdict(M->Res->Entry(D.second)->MainFile, debug);
+			auto Before{ TranslationsDone() };
+			Slyvina::uint64 Failed{ 0 };
+			for (auto& D : Dirty) {
+				if (!M->Res->EntryExists(D.second)) continue;
+				auto C{ Compile(M->PrjData, M->Res, D.second, debug, false) };
+				if (C->Result == CompileResult::Fail) Failed++;
+			}
+			for (auto& D : Dirty) if (M->Res->EntryExists(D.second)) MapEntry(M, D.second, debug);
+			WatchIncludes(W, IncDirs);
+			if ((!Failed) && !LinkProject(M, false, debug)) Failed++;
+			auto Rebuilt{ TranslationsDone() - Before };
+			auto ms{ std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - Start).count() };
+			auto Line{ TrSPrintF("%d checked, %d rebuilt, %d failed, %d ms", (int)Dirty.size(), (int)Rebuilt, (int)Failed, (int)ms) };
+			if (Failed) QCol->Red(CurrentTime() + "  " + Line + "\n"); else QCol->Green(CurrentTime() + "  " + Line + "\n");
+		}
+		return 0;
+	}
+}
@@ -0,0 +1,41 @@
+// License:
+// 
+// Scyndi
+// Watch mode (header)
+// 
+// 
+// 
+// 	(c) Jeroen P. Broks, 2026
+// 
+// 		This program is free software: you can redistribute it and/or modify
+// 		it under the terms of the GNU General Public License as published by
+// 		the Free Software Foundation, either version 3 of the License, or
+// 		(at your option) any later version.
+// 
+// 		This program is distributed in the hope that it will be useful,
+// 		but WITHOUT ANY WARRANTY; without even the implied warranty of
+// 		MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// 		GNU General Public License for more details.
+// 		You should have received a copy of the GNU General Public License
+// 		along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// 
+// 	Please note that some references to data like pictures or audio, do not automatically
+// 	fall under this licenses. Mostly this is noted in the respective files.
+// 
+// Version: 26.10.19
+// End License
+
+#pragma once
+#include <string>
+#include <Slyvina.hpp>
+
+namespace Scyndi {
+	/// <summary>
+	/// Builds the project, and then keeps it in memory, rebuilding the scripts affected by every change in the source directories. 
+	/// Only ends when the user ends the program (or when the project could not be loaded).
+	/// Kept in memory are the project, the dependency graph, the configurations of the STB files and the verdicts of the up to date checks.
+	/// So are the globals and macros each script brings to a #USE request, and the lines read from included files. Those are thrown away once their script is dirty or their file changed.
+	/// After a rebuild without failures the project is linked again (when it has a bundle).
+	/// </summary>
+	Slyvina::uint64 WatchProject(std::string prj, bool force = false, bool debug = false);
+}
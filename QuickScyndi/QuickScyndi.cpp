@@ -26,8 +26,17 @@
 // End License
 
 #include "../ScyndiVersion.hpp"
+#include "../Compiler/LZ4Block.hpp"
+#include "../Compiler/LineMap.hpp"
 
 #include <zlib.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <unordered_map>
 
 #include <Lunatic.hpp>
 
@@ -35,6 +44,8 @@
 #include <SlyvString.hpp>
 #include <SlyvStream.hpp>
 
+#include <SlyvGINIE.hpp>
+
 #include <JCR6_Core.hpp>
 #include <JCR6_zlib.hpp>
 
@@ -45,6 +56,20 @@ using namespace Slyvina::NSLunatic;
 using namespace Slyvina::JCR6;
 
 namespace Scyndi {
+	// Line maps of everything loaded (see Compiler/LineMap.hpp), keyed by chunk name. With those, errors and profiles are in Scyndi files and lines.
+	static std::map<std::string, LineMap> LineMaps{};
+
+	// Returns the chunk name of the (last) map read, or an empty string when there was nothing to read.
+	static std::string LoadLineMaps(JT_Dir J, std::string Entry) {
+		if (!J->EntryExists(Entry)) return "";
+		auto Buf{ J->Characters(Entry) };
+		std::map<std::string, LineMap> Maps{};
+		if (!ReadLineMaps(Buf.data(), Buf.size(), Maps)) QCol->Warn(Entry + " is damaged");
+		std::string ret{ "" };
+		for (auto& M : Maps) { LineMaps[M.first] = M.second; ret = M.first; }
+		return ret;
+	}
+
 	void Header(std::string MyExe) {
 		QCol->LGreen("Quick Scyndi Runner\n");
 		QCol->Doing("Version", QVersion.Version(true));
@@ -55,7 +80,24 @@ namespace Scyndi {
 		std::cout << "\n\n\n";
 		QCol->White("Usage: ");
 		QCol->Yellow(StripAll(MyExe));		
-		QCol->LCyan(" <STB Bundle>\n\n");
+		QCol->LCyan(" <STB Bundle> [<STB Bundle>...]\n\n");
+		QCol->Yellow("Linked bundles (see [Link] in the project file) are loaded as a whole in one go\n\n");
+		QCol->White("       ");
+		QCol->Yellow(StripAll(MyExe));
+		QCol->LCyan(" -bench <STB Bundle> [<STB Bundle>...]\n");
+		QCol->Yellow("Compares size and expansion time of all entries for the storage methods Scyndi can use\n\n");
+		QCol->White("       ");
+		QCol->Yellow(StripAll(MyExe));
+		QCol->LCyan(" -corebench [<iterations>] [<JSON file>]\n");
+		QCol->Yellow("Times the core operations with ScyndiCoreBench.lua, and saves the results (ns/op and bytes/op) as JSON\n\n");
+		QCol->White("       ");
+		QCol->Yellow(StripAll(MyExe));
+		QCol->LCyan(" -profile [-interval <instructions>] <STB Bundle> [<STB Bundle>...]\n");
+		QCol->Yellow("Samples the Lua stack every <instructions> VM instructions (default 1000), and writes the stacks in Scyndi lines in the folded format flame graph tools read\n\n");
+		QCol->White("       ");
+		QCol->Yellow(StripAll(MyExe));
+		QCol->LCyan(" -boot <Linked Bundle>\n");
+		QCol->Yellow("Boots the program from the STB files it was linked from and from the linked bundle, and compares the time until every script has loaded and run\n\n");
 	}
 
 	int Paniek(lua_State* L) {
@@ -67,7 +109,7 @@ namespace Scyndi {
 			QCol->Magenta(TrSPrintF("Arg #%03d\t", i));
 			switch (lua_type(L, i)) {
 			case LUA_TSTRING:
-				QCol->Doing("String", "\"" + std::string(luaL_checkstring(L, i)) + "\"");
+				QCol->Doing("String", "\"" + MapTrace(luaL_checkstring(L, i), LineMaps) + "\"");
 				//Trace += luaL_checkstring(L, i); Trace += "\n";
 				break;
 			case LUA_TNUMBER:
@@ -88,6 +130,425 @@ namespace Scyndi {
 }
 
 
+namespace Scyndi {
+	static uint32 GetInt(std::vector<char>& Buf, size_t& Pos) {
+		uint32 ret{ 0 };
+		for (int b = 0; b < 4; b++) ret |= ((uint32)(unsigned char)Buf[Pos++]) << (b * 8);
+		return ret;
+	}
+
+	static std::string GetString(std::vector<char>& Buf, size_t& Pos) {
+		auto l{ GetInt(Buf, Pos) };
+		std::string ret{ Buf.data() + Pos, l };
+		Pos += l;
+		return ret;
+	}
+
+	static void CheckLua(lua_State* L, int status) {
+		if (status != LUA_OK) Paniek(L);
+	}
+
+	static void CallCore(lua_State* L, const char* Func, std::string A, std::string B) {
+		lua_getglobal(L, "Scyndi");
+		lua_getfield(L, -1, Func);
+		lua_pushstring(L, A.c_str());
+		lua_pushstring(L, B.c_str());
+		CheckLua(L, lua_pcall(L, 2, 0, 0));
+		lua_pop(L, 1);
+	}
+
+	// Upvalues: program, offset, size, name
+	static int LazyLoader(lua_State* L) {
+		auto Program{ (const char*)lua_touserdata(L, lua_upvalueindex(1)) };
+		auto Offset{ (size_t)lua_tointeger(L, lua_upvalueindex(2)) };
+		auto Size{ (size_t)lua_tointeger(L, lua_upvalueindex(3)) };
+		auto Name{ lua_tostring(L, lua_upvalueindex(4)) };
+		CheckLua(L, luaL_loadbuffer(L, Program + Offset, Size, Name));
+		return 1;
+	}
+
+#pragma region "Profiler"
+	// Every Interval VM instructions the hook takes the whole Lua stack, and counts how often every stack was seen.
+	// Frames are named after the Scyndi files and lines they came from, by means of the line maps.
+	// Coroutines inherit the hook from the thread creating them, so they are sampled as well.
+	struct _Profiler {
+		int Interval{ 1000 };
+		uint64 Samples{ 0 };
+		bool Stripped{ false };
+		std::unordered_map<std::string, uint64> Stacks{};
+
+		std::string Frame(lua_Debug& D) {
+			std::string Name{ D.name ? D.name : "" };
+			std::string What{ D.what ? D.what : "" };
+			if (What == "C") return "[C] " + (Name.size() ? Name : std::string("?"));
+			if (!Name.size()) Name = What == "main" ? "<main>" : "<function>";
+			if (D.currentline < 0) { Stripped = true; return Name + " (" + D.short_src + ")"; }
+			auto M{ LineMaps.find(std::string(D.source, D.srclen)) };
+			std::string File{ "" };
+			uint32 Line{ 0 };
+			if (M != LineMaps.end() && M->second->Lookup((uint32)D.currentline, File, Line)) return Name + " (" + File + ":" + std::to_string(Line) + ")";
+			return Name + " (" + D.short_src + ":" + std::to_string(D.currentline) + ")";
+		}
+
+		// Folded stacks: One line per stack, root first, frames separated by ;, followed by the number of samples.
+		void Save(std::string File) {
+			std::string Out{ "" };
+			std::map<std::string, uint64> Leaves{};
+			for (auto& S : Stacks) {
+				Out += S.first + " " + std::to_string(S.second) + "\n";
+				auto p{ S.first.find_last_of(';') };
+				Leaves[p == std::string::npos ? S.first : S.first.substr(p + 1)] += S.second;
+			}
+			SaveString(File, Out);
+			QCol->Doing("Samples", Samples);
+			QCol->Doing("Stacks", (uint64)Stacks.size());
+			QCol->Doing("Saved", File);
+			if (Stripped) QCol->Warn("Some bytecode had no line info. Profile a build with a .Symbols.STB sidecar or without [Package] Profile=Release");
+			std::vector<std::pair<std::string, uint64>> Hot{ Leaves.begin(),Leaves.end() };
+			std::sort(Hot.begin(), Hot.end(), [](const std::pair<std::string, uint64>& a, const std::pair<std::string, uint64>& b) { return a.second > b.second; });
+			for (size_t i = 0; i < Hot.size() && i < 10; i++) {
+				QCol->LCyan(TrSPrintF("%6.2f%% ", Samples ? (Hot[i].second * 100.0) / Samples : 0.0));
+				QCol->Yellow(Hot[i].first + "\n");
+			}
+		}
+	};
+	static std::unique_ptr<_Profiler> Prof{ nullptr };
+
+	static void ProfileHook(lua_State* L, lua_Debug*) {
+		std::string Stack{ "" };
+		lua_Debug D;
+		for (int Level = 0; lua_getstack(L, Level, &D); Level++) {
+			lua_getinfo(L, "Sln", &D);
+			Stack = Stack.size() ? Prof->Frame(D) + ";" + Stack : Prof->Frame(D);
+		}
+		Prof->Stacks[Stack]++;
+		Prof->Samples++;
+	}
+#pragma endregion
+
+	static lua_State* NewState(std::string& ScyndiCore) {
+		auto L{ luaL_newstate() };
+		lua_atpanic(L, Paniek);
+		luaL_openlibs(L);
+		if (Prof) lua_sethook(L, ProfileHook, LUA_MASKCOUNT, Prof->Interval);
+		CheckLua(L, luaL_loadbuffer(L, ScyndiCore.c_str(), ScyndiCore.size(), "ScyndiCore"));
+		CheckLua(L, lua_pcall(L, 0, 0, 0));
+		return L;
+	}
+
+	static int Traceback(lua_State* L) {
+		luaL_traceback(L, L, lua_tostring(L, 1), 1);
+		return 1;
+	}
+
+	// Stripped bytecode has no line info, but every function in it still knows the line it was defined at.
+	// Frames in stripped code get that line as "<stripped:line>", for Unstrip() to look up once the line map in the sidecar is read.
+	static int StrippedTraceback(lua_State* L) {
+		std::string Msg{ lua_tostring(L, 1) ? lua_tostring(L, 1) : "Unknown error" };
+		if (Prefixed(Msg, "?:-1: ")) Msg = Msg.substr(6); // Where Lua would put the line
+		auto ret{ Msg + "\nstack traceback:" };
+		lua_Debug D;
+		for (int Level = 1; lua_getstack(L, Level, &D); Level++) {
+			lua_getinfo(L, "Sln", &D);
+			std::string Name{ D.name ? std::string("'") + D.name + "'" : "?" };
+			if (D.currentline >= 0) ret += TrSPrintF("\n\t%s:%d: in %s", D.short_src, D.currentline, Name.c_str());
+			else if (D.what[0] == 'C') ret += "\n\t[C]: in " + Name;
+			else if (D.what[0] == 'm') ret += "\n\t<stripped:0>: in main chunk";
+			else ret += TrSPrintF("\n\t<stripped:%d>: in function%s", D.linedefined, D.name ? (" " + Name).c_str() : "");
+		}
+		lua_pushstring(L, ret.c_str());
+		return 1;
+	}
+
+	static std::string Unstrip(std::string Trace, std::string Chunk) {
+		const std::string Tag{ "<stripped:" };
+		size_t p{ 0 };
+		while ((p = Trace.find(Tag, p)) != std::string::npos) {
+			auto e{ Trace.find('>', p) };
+			if (e == std::string::npos || e - p - Tag.size() > 9) break;
+			auto LineDefined{ (uint32)std::atoi(Trace.substr(p + Tag.size(), e - p - Tag.size()).c_str()) };
+			std::string File{ "" }, Pos{ "" };
+			uint32 Line{ 0 };
+			if (LineDefined && LineMaps.count(Chunk) && LineMaps[Chunk]->Lookup(LineDefined, File, Line)) Pos = TrSPrintF("%s:%d (function start)", File.c_str(), (int)Line);
+			else if (LineMaps.count(Chunk) && LineMaps[Chunk]->Files.size()) Pos = LineMaps[Chunk]->Files[0];
+			else Pos = Chunk;
+			Trace = Trace.substr(0, p) + Pos + Trace.substr(e + 1);
+			p += Pos.size();
+		}
+		return Trace;
+	}
+
+	// Returns the error message with traceback, or an empty string when all went well
+	// Works for source as well. Name is then the chunk name.
+	static std::string RunChunk(std::string& ScyndiCore, const char* Buf, size_t Size, std::string Name, lua_CFunction Handler = Traceback) {
+		auto L{ NewState(ScyndiCore) };
+		std::string ret{ "" };
+		lua_pushcfunction(L, Handler);
+		if (luaL_loadbuffer(L, Buf, Size, Name.c_str()) != LUA_OK || lua_pcall(L, 0, 0, 1) != LUA_OK) 
+			ret = lua_tostring(L, -1) ? MapTrace(lua_tostring(L, -1), LineMaps) : "Unknown error";
+		lua_close(L);
+		return ret;
+	}
+
+	static std::string RunByteCode(std::string& ScyndiCore, std::vector<char>& BC, std::string Name, lua_CFunction Handler = Traceback) { return RunChunk(ScyndiCore, BC.data(), BC.size(), Name, Handler); }
+
+	// Release bundles have no Lua source and no debug info. That's in the .Symbols.STB sidecar, which is only read when an error must be traced back.
+	// The program is never run again for that, as that would repeat everything it did, so the error is traced back as far as the stripped bytecode allows:
+	// to the start of every function on the stack.
+	static void RunRelease(std::string ScyndiCore, JT_Dir J, std::string File) {
+		auto Sym{ StripExt(File) + ".Symbols.STB" };
+		if (Prof && FileExists(Sym)) {
+			// Same program, but with line info
+			auto JS{ JCR6_Dir(Sym) };
+			if (JS) {
+				LoadLineMaps(JS, "LineMap.bin");
+				auto SBC{ JS->Characters("ByteCode.lbc") };
+				auto SErr{ RunByteCode(ScyndiCore, SBC, StripAll(File)) };
+				if (SErr.size()) { QCol->Error(SErr); exit(11); }
+				return;
+			}
+		}
+		auto BC{ J->Characters("ByteCode.lbc") };
+		auto Err{ RunByteCode(ScyndiCore, BC, StripAll(File), StrippedTraceback) };
+		if (!Err.size()) return;
+		if (!FileExists(Sym)) { QCol->Error(Err); QCol->Warn(Sym + " not found, so the error cannot be traced back"); exit(11); }
+		auto JS{ JCR6_Dir(Sym) };
+		if (!JS) { QCol->Error(Err); QCol->Error("Could not read " + Sym + ". " + Last()->ErrorMessage); exit(11); }
+		QCol->Doing("Symbols", Sym);
+		QCol->Error(Unstrip(Err, LoadLineMaps(JS, "LineMap.bin")));
+		QCol->Yellow("Release bytecode has no line info, so only the lines at which the functions start are known\n");
+		exit(11);
+	}
+
+	// The whole program comes from one read out of one archive. Every script is handed over to Scyndi.LinkChunk, 
+	// and then they are "used" in the order the linker put them in, so all dependencies are in place before a script runs.
+	// Scripts the linker marked as lazy go to Scyndi.LinkLazy in stead, and are only compiled when something they define is accessed.
+	static void RunLinked(std::string ScyndiCore, JT_Dir J) {
+		auto Index{ J->Characters("Link/Index.bin") };
+		auto Program{ J->Characters("Link/Program.lbc") };
+		size_t Pos{ 4 };
+		if (Index.size() < 12 || std::string(Index.data(), 4) != "SLNK") { QCol->Error("Linked bundle has an invalid index"); exit(100); }
+		auto Version{ GetInt(Index, Pos) };
+		if (Version < 1 || Version > 2) { QCol->Error("Linked bundle has an unsupported index version"); exit(100); }
+		auto L{ NewState(ScyndiCore) };
+		auto Count{ GetInt(Index, Pos) };
+		std::vector<std::string> Order{};
+		std::vector<bool> Lazy{};
+		uint32 LazyCount{ 0 };
+		for (uint32 i = 0; i < Count; i++) {
+			auto Name{ GetString(Index, Pos) };
+			auto Offset{ GetInt(Index, Pos) };
+			auto Size{ GetInt(Index, Pos) };
+			auto Flags{ Version >= 2 ? GetInt(Index, Pos) : 0 };
+			if ((size_t)Offset + Size > Program.size()) { QCol->Error("Linked bundle is damaged (" + Name + ")"); exit(100); }
+			Order.push_back(Name);
+			Lazy.push_back(Flags & 1);
+			if (Flags & 1) {
+				lua_getglobal(L, "Scyndi");
+				lua_getfield(L, -1, "LinkLazy");
+				lua_pushstring(L, Name.c_str());
+				lua_pushlightuserdata(L, Program.data());
+				lua_pushinteger(L, Offset);
+				lua_pushinteger(L, Size);
+				lua_pushstring(L, Name.c_str());
+				lua_pushcclosure(L, LazyLoader, 4);
+				CheckLua(L, lua_pcall(L, 2, 0, 0));
+				lua_pop(L, 1);
+				LazyCount++;
+				continue;
+			}
+			lua_getglobal(L, "Scyndi");
+			lua_getfield(L, -1, "LinkChunk");
+			lua_pushstring(L, Name.c_str());
+			CheckLua(L, luaL_loadbuffer(L, Program.data() + Offset, Size, Name.c_str()));
+			CheckLua(L, lua_pcall(L, 2, 0, 0));
+			lua_pop(L, 1);
+		}
+		if (LazyCount) {
+			// Globals, then classes. Only the ones of lazy scripts matter.
+			auto Globals{ GetInt(Index, Pos) };
+			for (uint32 i = 0; i < Globals; i++) {
+				auto Name{ GetString(Index, Pos) };
+				auto Script{ GetInt(Index, Pos) };
+				GetString(Index, Pos); // Substitute
+				if (Lazy[Script]) CallCore(L, "Provides", Name, Order[Script]);
+			}
+			auto Classes{ GetInt(Index, Pos) };
+			for (uint32 i = 0; i < Classes; i++) {
+				auto Name{ GetString(Index, Pos) };
+				auto Script{ GetInt(Index, Pos) };
+				if (Lazy[Script]) CallCore(L, "Provides", Name, Order[Script]);
+			}
+			QCol->Doing("Lazy", TrSPrintF("%d of %d scripts", (int)LazyCount, (int)Count));
+		}
+		for (uint32 i = 0; i < Count; i++) {
+			if (Lazy[i]) continue;
+			auto& Name{ Order[i] };
+			lua_getglobal(L, "Scyndi");
+			lua_getfield(L, -1, "Use");
+			lua_pushstring(L, Name.c_str());
+			CheckLua(L, lua_pcall(L, 1, 0, 0));
+			lua_pop(L, 1);
+		}
+		lua_close(L);
+	}
+
+	// The program is booted twice, so everything the scripts do when they run, they do twice.
+	// Lazy scripts are not taken into account, as the STB files have no way to be lazy. So with [Link] Lazy=TRUE the linked bundle gets an edge.
+	static int Boot(int c, char** args, std::string& ScyndiCore) {
+		if (c < 3) { QCol->Error("No linked bundle given"); return 400; }
+		std::string Bundle{ args[2] };
+		auto J{ JCR6_Dir(Bundle) };
+		if (!J) { QCol->Error("Could not read " + Bundle + ". " + Last()->ErrorMessage); return 500; }
+		if (!J->EntryExists("Link/Index.bin")) { QCol->Error(Bundle + " is not a linked bundle"); return 400; }
+		auto STBs{ ParseGINIE(J->GetString("Link/Configuration.ini"))->List("Link", "STB") };
+		auto Index{ J->Characters("Link/Index.bin") };
+		size_t Pos{ 4 };
+		auto Version{ Index.size() >= 12 ? GetInt(Index, Pos) : 0 };
+		auto Count{ Version == 2 ? GetInt(Index, Pos) : 0 };
+		if (!Count || Count != STBs->size()) { QCol->Error(Bundle + " doesn't tell which STB files it was linked from. Link the project again."); return 400; }
+		std::vector<std::string> Names{};
+		for (uint32 i = 0; i < Count; i++) {
+			Names.push_back(GetString(Index, Pos));
+			Pos += 12; // Offset, size and flags
+		}
+		J = nullptr;
+		QCol->Doing("Scripts", (int)Count);
+		// The same way RunLinked() does it, but every script out of its own STB
+		auto Start{ std::chrono::steady_clock::now() };
+		auto L{ NewState(ScyndiCore) };
+		for (uint32 i = 0; i < Count; i++) {
+			auto JS{ JCR6_Dir((*STBs)[i]) };
+			if (!JS) { QCol->Error("Could not read " + (*STBs)[i] + ". " + Last()->ErrorMessage); return 500; }
+			auto BC{ JS->Characters("ByteCode.lbc") };
+			lua_getglobal(L, "Scyndi");
+			lua_getfield(L, -1, "LinkChunk");
+			lua_pushstring(L, Names[i].c_str());
+			CheckLua(L, luaL_loadbuffer(L, BC.data(), BC.size(), Names[i].c_str()));
+			CheckLua(L, lua_pcall(L, 2, 0, 0));
+			lua_pop(L, 1);
+		}
+		for (auto& Name : Names) {
+			lua_getglobal(L, "Scyndi");
+			lua_getfield(L, -1, "Use");
+			lua_pushstring(L, Name.c_str());
+			CheckLua(L, lua_pcall(L, 1, 0, 0));
+			lua_pop(L, 1);
+		}
+		auto Separate{ std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count() };
+		lua_close(L);
+		std::cout << "\n";
+		Start = std::chrono::steady_clock::now();
+		J = JCR6_Dir(Bundle);
+		if (!J) { QCol->Error("Could not read " + Bundle + ". " + Last()->ErrorMessage); return 500; }
+		RunLinked(ScyndiCore, J);
+		auto Linked{ std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count() };
+		std::cout << "\n";
+		QCol->Doing("STB files", TrSPrintF("%.2f ms", Separate));
+		QCol->Doing("Linked bundle", TrSPrintF("%.2f ms", Linked));
+		QCol->Reset();
+		return 0;
+	}
+}
+
+
+namespace Scyndi {
+	struct _BenchResult { std::string Name; uint64 Size{ 0 }; double Time{ 0 }; };
+
+	static double Ms(std::chrono::steady_clock::time_point Start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count();
+	}
+
+	// Expands Packed over and over till it took long enough to be measured properly, and returns the time of one expansion
+	template<class Exp> static double TimeExpand(Exp Expand) {
+		uint64 Reps{ 0 };
+		auto Start{ std::chrono::steady_clock::now() };
+		double Spent{ 0 };
+		do { if (!Expand()) return -1; Reps++; Spent = Ms(Start); } while (Spent < 20 && Reps < 10000);
+		return Spent / Reps;
+	}
+
+	static int Bench(int c, char** args) {
+		std::vector<_BenchResult> Res{ {"Store"},{"zlib"},{LZ4BlockStorage} };
+		uint64 Entries{ 0 }, Raw{ 0 };
+		for (int i = 2; i < c; i++) {
+			auto J{ JCR6_Dir(args[i]) };
+			if (!J) { QCol->Error("Could not read " + std::string(args[i]) + ". " + Last()->ErrorMessage); return 500; }
+			for (auto E : *J->Entries()) {
+				auto Data{ J->Characters(E->Name()) };
+				if (!Data.size()) continue;
+				std::vector<char> Out(Data.size());
+				Entries++;
+				Raw += Data.size();
+				// Store
+				auto StoreTime{ TimeExpand([&]() { memcpy(Out.data(), Data.data(), Data.size()); return true; }) };
+				Res[0].Size += Data.size();
+				Res[0].Time += StoreTime;
+				// zlib
+				uLongf zs{ compressBound((uLong)Data.size()) };
+				std::vector<Bytef> Z(zs);
+				compress2(Z.data(), &zs, (Bytef*)Data.data(), (uLong)Data.size(), Z_DEFAULT_COMPRESSION);
+				Res[1].Size += zs;
+				Res[1].Time += TimeExpand([&]() { uLongf os{ (uLongf)Out.size() }; return uncompress((Bytef*)Out.data(), &os, Z.data(), zs) == Z_OK; });
+				// LZ4 block (stored as is when it doesn't shrink, just like JCR6 would do)
+				std::vector<char> L(Data.size());
+				auto ls{ LZ4BlockCompress(Data.data(), Data.size(), L.data(), L.size()) };
+				if (ls) {
+					Res[2].Size += ls;
+					Res[2].Time += TimeExpand([&]() { return LZ4BlockExpand(L.data(), ls, Out.data(), Out.size()); });
+				} else {
+					Res[2].Size += Data.size();
+					Res[2].Time += StoreTime;
+				}
+			}
+		}
+		QCol->Doing("Bundles", c - 2);
+		QCol->Doing("Entries", Entries);
+		QCol->Doing("Raw size", Raw);
+		for (auto& R : Res) {
+			QCol->Yellow(TrSPrintF("%-10s", R.Name.c_str()));
+			QCol->LCyan(TrSPrintF("%12llu bytes (%5.1f%%)", (unsigned long long)R.Size, Raw ? (R.Size * 100.0) / Raw : 0.0));
+			QCol->LGreen(TrSPrintF("%10.3f ms to expand everything\n", R.Time));
+		}
+		QCol->Reset();
+		return 0;
+	}
+}
+
+namespace Scyndi {
+	static int BenchNow(lua_State* L) {
+		lua_pushinteger(L, (lua_Integer)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+		return 1;
+	}
+
+	static int CoreBench(int c, char** args, std::string& ScyndiCore) {
+		auto BenchFile{ ExtractDir(args[0]) + "/ScyndiCoreBench.lua" }; if (!FileExists(BenchFile)) { QCol->Error(BenchFile + " not found"); return 404; }
+		auto Iterations{ c > 2 ? atoi(args[2]) : 200000 }; if (Iterations <= 0) { QCol->Error("Invalid number of iterations"); return 400; }
+		auto JSONFile{ c > 3 ? std::string(args[3]) : std::string("ScyndiCoreBench.json") };
+		auto Bench{ FLoadString(BenchFile) };
+		auto L{ NewState(ScyndiCore) };
+		lua_newtable(L);
+		lua_pushinteger(L, Iterations);
+		lua_setfield(L, -2, "Iterations");
+		lua_pushcfunction(L, BenchNow);
+		lua_setfield(L, -2, "Now");
+		lua_setglobal(L, "ScyndiBench");
+		QCol->Doing("Iterations", Iterations);
+		std::cout << "\n";
+		lua_pushcfunction(L, Traceback);
+		if (luaL_loadbuffer(L, Bench.c_str(), Bench.size(), "ScyndiCoreBench") != LUA_OK || lua_pcall(L, 0, 1, 1) != LUA_OK) {
+			QCol->Error(lua_tostring(L, -1) ? lua_tostring(L, -1) : "Unknown error");
+			lua_close(L);
+			return 11;
+		}
+		SaveString(JSONFile, lua_tostring(L, -1));
+		lua_close(L);
+		QCol->Doing("Saved", JSONFile);
+		QCol->Reset();
+		return 0;
+	}
+}
+
 int main(int c, char** args) {
 	using namespace Scyndi;
 	if (c < 2) {
@@ -95,19 +556,51 @@ int main(int c, char** args) {
 		return 0;
 	}
 	init_zlib();
+	init_lz4block();
+	if (std::string(args[1]) == "-bench") return Bench(c, args);
 	auto d{ ExtractDir(args[0]) };
 	auto ScyndiCoreFile{ d + "/ScyndiCore.lua" }; if (!FileExists(ScyndiCoreFile)) { QCol->Error(ScyndiCoreFile + " not found"); return 404; }
 	auto ScyndiCore{ FLoadString(ScyndiCoreFile) };
 	_Lunatic::Panick = Paniek;
-	for (int i = 1; i < c; i++) {
-		auto L{ LunaticBySource(ScyndiCore) };
+	if (std::string(args[1]) == "-corebench") return CoreBench(c, args, ScyndiCore);
+	if (std::string(args[1]) == "-boot") return Boot(c, args, ScyndiCore);
+	int First{ 1 };
+	if (std::string(args[1]) == "-profile") {
+		Prof = std::make_unique<_Profiler>();
+		First = 2;
+		if (c > 3 && std::string(args[2]) == "-interval") { Prof->Interval = atoi(args[3]); First = 4; }
+		if (Prof->Interval <= 0) { QCol->Error("Invalid interval"); return 400; }
+		if (First >= c) { QCol->Error("Nothing to profile"); return 400; }
+		QCol->Doing("Profiling", TrSPrintF("every %d instructions", Prof->Interval));
+	}
+	double RunTime{ 0 };
+	for (int i = First; i < c; i++) {
+		auto Start{ std::chrono::steady_clock::now() };
 		auto J{ JCR6_Dir(args[i]) };
 		if (!J) { QCol->Error("Could not read " + std::string(args[i]) + ". " + Last()->ErrorMessage); return 500; }
-		auto src = J->GetString("Translation.lua"); // Easiest way to go. It's only a test tool after all!
-		if (Last()->Error) { QCol->Error(Last()->ErrorMessage); return 100; }
-		L->QDoString(src);
+		if (J->EntryExists("Link/Index.bin")) {
+			LoadLineMaps(J, "Link/LineMap.bin");
+			RunLinked(ScyndiCore, J);
+		} else if (!J->EntryExists("Translation.lua")) {
+			RunRelease(ScyndiCore, J, args[i]);
+		} else if (J->EntryExists("LineMap.bin")) {
+			// The source is compiled with the chunk name the line map knows, so errors and profiles come in Scyndi lines. 
+			// The bytecode of non-debug builds has no line info, so it wouldn't do for that.
+			auto Chunk{ LoadLineMaps(J, "LineMap.bin") };
+			auto src{ J->GetString("Translation.lua") };
+			auto Err{ RunChunk(ScyndiCore, src.c_str(), src.size(), Chunk) };
+			if (Err.size()) { QCol->Error(Err); return 11; }
+		} else {
+			auto L{ LunaticBySource(ScyndiCore) };
+			auto src = J->GetString("Translation.lua"); // Easiest way to go. It's only a test tool after all!
+			if (Last()->Error) { QCol->Error(Last()->ErrorMessage); return 100; }
+			L->QDoString(src);
+		}
+		RunTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count();
 		std::cout << "\n\n";
 	}
+	QCol->Doing("Run time", TrSPrintF("%.2f ms", RunTime)); // The whole program. See -boot for only the loading of it.
+	if (Prof) Prof->Save(StripExt(args[First]) + ".folded");
 	QCol->Reset();
 	return 0;
 }
@@ -125,6 +125,23 @@ local Identifier = {}
 -- ***** Class Functions ***** --
 local classregister = {}
 
+-- ***** Linked modules ***** --
+-- Filled by the loader of a linked bundle (see Compiler/Link.hpp). Module names are case insensitive here, just like in JCR6.
+local Linked = {} -- Chunks ready to run (true once they ran)
+local Lazy = {} -- Loaders of modules that aren't resident yet
+local Provider = {} -- Global or class => module defining it
+
+-- Loads the module defining key, if that didn't happen yet. Returns true if it did load something.
+local function Resident(key)
+	local m = Provider[key]
+	if not (m and Lazy[m]) then return false end
+	local loader = Lazy[m]
+	Lazy[m] = nil
+	Linked[m] = loader()
+	_Scyndi.USE(m)
+	return true
+end
+
 local function index_static_member(cl,key,allowprivate)
 	local cu=cl:upper()
 	key=key:upper()
@@ -141,6 +158,7 @@ local function index_static_member(cl,key,allowprivate)
 	if key==".CLASSINSTANCE" then
 		return nil
 	end
+	if cu=="..GLOBALS.." and (not classregister[cu].staticmembers[key]) and Resident(key) then return index_static_member(cl,key,allowprivate) end
 	if not classregister[cu].staticmembers[key] then
 		--local fuckyou = debug.traceback()
 		print(debug.traceback())
@@ -169,7 +187,7 @@ local function newindex_static_member(cl,key,value,allowprivate)
 		classregister[cu].staticprop.pset[key](classregister[cu].pub,value)
 		return
 	end
-
+	if cu=="..GLOBALS.." and (not classregister[cu].staticmembers[key]) and Resident(key) then return newindex_static_member(cl,key,value,allowprivate) end
 	assert(classregister[cu].staticmembers[key],"NI:Class "..cl.." has no static member named "..key)
 	local member=classregister[cu].staticmembers[key]
 	if (not allowprivate) then assert(not member.private,"Class "..cl.." does have a static member named "..key..", however it's private and cannot be called this way.") end
@@ -180,19 +198,18 @@ local function newindex_static_member(cl,key,value,allowprivate)
 	member.value = _Scyndi.WANTVALUE(member.dtype,value)
 end
 
-local function tabcpy(ori)
-	local tar = {}
-	for k,v in pairs(ori) do
-		if type(v)=="table" then 
-			tar[k] = tabcpy(v)
-		else
-			tar[k] = v
-		end
-	end
-	return tar
-end
-
 -- Perform Extend Class
+--[[
+	Extending links the tables of a class to those of its base, so
+	whatever the class doesn't have itself is looked up in there.
+	That way extending only costs the class's own members.
+	Static members are the exception. These are copied into the class
+	when first used, so a class and its base keep their own values.
+	Overriding an inherited abstract leaves a false in the abstracts, to
+	hide the one in the base.
+]]
+local function ChainTo(tab,base) return setmetatable(tab,{__index=base}) end
+local function Changed(_class) _class.flat=nil _class.dispatch=nil end -- Drops what's been resolved from the class so far
 local function PEC(classname)
 	local cu = classname:upper()
 	local _class = classregister[cu]
@@ -200,33 +217,200 @@ local function PEC(classname)
 	if (_class.extended) then return end -- Don't extend again if that's already done
 	if _class.extendclass then
 		local uex = _class.extendclass:upper()
+		if not classregister[uex] then Resident(uex) end
 		assert(classregister[uex],"Extending non-existing class: ".._class.extendclass)
 		local base = classregister[uex]
+		PEC(uex)
 		base.sealed=true -- extending a class must seal the base. 
 		_class.extends = { base=base, extname=uex }
-		for _,k in pairs{"staticmembers","nonstaticmembers","methods","staticprop","methprop","abstracts","finals"} do
-			print(string.format("Extending - copy %s from %s to %s",k,_class.extendclass,classname)) -- debug only
-			--_class[k] = tabcpy(base[k])
-			local t=tabcpy(base[k])
-			if (k=="staticprop" or k=="methprop") then
-				for _,kp in pairs{"pget","pset"} do
-					for km,vm in pairs(t[kp]) do
-						_class[k][kp][km] = _class[k][kp][km] or vm
+		for _,k in ipairs{"nonstaticmembers","methods","abstracts","finals"} do ChainTo(_class[k],base[k]) end
+		for _,k in ipairs{"staticprop","methprop"} do
+			ChainTo(_class[k].pget,base[k].pget)
+			ChainTo(_class[k].pset,base[k].pset)
+		end
+		local basestatic = base.staticmembers
+		setmetatable(_class.staticmembers,{__index=function(t,key)
+			local m = basestatic[key]
+			if not m then return nil end
+			local own = { dtype=m.dtype, readonly=m.readonly, constant=m.constant, private=m.private, value=m.value }
+			rawset(t,key,own)
+			return own
+		end})
+		_class.extended = true
+		Changed(_class)
+	end
+end
+
+local InstanceIndex,InstanceNewIndex -- Defined below, with NEW
+
+-- Lua keeps objects with a finalizer around for an extra collection, so only
+-- instances of classes with a DESTRUCTOR (their own or an inherited one) get one.
+local function Finalize(self)
+	if not rawget(self,".released") then self[".Methods"].DESTRUCTOR(self) end
+end
+
+-- All abstracts, methods and non-static members of a class and its bases, for NEW,
+-- and the metatable all its instances share.
+-- Made when first needed (or when the class is sealed), and dropped again whenever the class itself gets something new.
+local function Flat(_class)
+	if _class.flat then return _class.flat end
+	local chain = {}
+	local c = _class
+	while c do
+		table.insert(chain,1,c)
+		c = c.extends.base
+	end
+	local f = { abstracts={}, methods={}, nonstaticmembers={} }
+	for _,c in ipairs(chain) do
+		for k,ft in pairs(f) do
+			for name,v in pairs(c[k]) do
+				if v then ft[name]=v else ft[name]=nil end
+			end
+		end
+	end
+	f.meta = { __index=InstanceIndex, __newindex=InstanceNewIndex }
+	if f.methods.DESTRUCTOR then f.meta.__gc=Finalize end
+	_class.flat = f
+	return f
+end
+
+local function Unabstract(_class,name)
+	if not _class.abstracts[name] then return end
+	if _class.extends.base then _class.abstracts[name]=false else _class.abstracts[name]=nil end
+end
+
+-- ***** Dispatch ***** --
+--[[
+	Every class has tables resolving a member name to a function
+	accessing it, for static and instance access alike. A name is
+	resolved the first time it's used (in whatever case it's used in)
+	and the tables are thrown away whenever the class gets something new.
+	That way accessing a member costs the same, no matter how many members
+	or bases the class has. Names that can't be resolved go the old way,
+	which also takes care of the errors and the lazily linked modules.
+]]
+local Resolve = {}
+
+function Resolve.sget(_class,key)
+	local pget=_class.staticprop.pget[key]
+	if pget then return function() return pget(_class.pub) end end
+	if key==".ISCLASS" then return function() return true end end
+	if key==".HASMEMBER" then return function() return function(m) return _class.staticmembers[m:upper()]~=nil end end end
+	if key==".CLASSINSTANCE" then return function() return nil end end
+	local member=_class.staticmembers[key]
+	if not member then return nil end
+	return function(allowprivate)
+		if member.private and not allowprivate then error("Class ".._class.name.." does have a static member named "..key..", however it's private and cannot be called this way.") end -- Not an assert, as that would build the message on every access
+		return member.value
+	end
+end
+
+function Resolve.sset(_class,key)
+	local pset=_class.staticprop.pset[key]
+	if pset then return function(value) pset(_class.pub,value) end end
+	local member=_class.staticmembers[key]
+	if not member then return nil end
+	return function(value,allowprivate)
+		if member.private and not allowprivate then error("Class ".._class.name.." does have a static member named "..key..", however it's private and cannot be called this way.") end
+		member.value = _Scyndi.WANTVALUE(member.dtype,value)
+	end
+end
+
+function Resolve.iget(_class,key)
+	if key=="CONSTRUCTOR" or key=="DESTRUCTOR" then return function() error("Illegal "..key:lower().." call") end end
+	if key==".CLASSINSTANCE" or key==".ISCLASSINSTANCE" then return function() return true end end
+	if key==".CLASSNAME" then return function(self) return self[".TiedToClass"].CL.name end end
+	if key==".ISCLASS" then return function() return false end end
+	if key==".HASMEMBER" then
+		return function(self) 
+			return function(key)
+				if self[".Methods"][key] then return true end
+				if self[".TiedToClass"].CR.staticmembers[key] then return true end
+				if self[".TiedToClass"].CR.nonstaticmembers[key] then return true end
+				if self[".TiedToClass"].CR.methprop.pget[key] then return true end
+				if self[".TiedToClass"].CR.staticprop.pget[key] then return true end
+				return false
+			end
+		end
+	end
+	if _class.methods[key] then
+		-- Bound methods are kept in the instance, so calling a method doesn't make a new closure every time
+		-- RELEASE throws them away. Those of a pooled class check that they still belong to the instance, so one kept from before RELEASE can't be used.
+		local pooled = _class.pool
+		return function(self)
+			local bound = rawget(self,".Bound")
+			if not bound then
+				bound = {}
+				rawset(self,".Bound",bound)
+			end
+			local f = bound[key]
+			if not f then
+				local m = self[".Methods"][key]
+				if pooled then
+					f = function(...)
+						if rawget(self,".Bound")~=bound then error("This instance of "..self[".TiedToClass"].CH.." has been released, and can't be used anymore") end
+						return m(self,...)
 					end
+				else
+					f = function(...) return m(self,...) end
 				end
-			else
-				for km,vm in pairs(t) do
-					_class[k][km] = _class[k][km] or vm
-				end
+				bound[key] = f
 			end
-			for mk,v in pairs(_class[k]) do print("\t",type(v),mk) end
-			_class.extended = true
+			return f
 		end
 	end
+	local member=_class.staticmembers[key]
+	if member then
+		local sget=Resolve.sget(_class,key)
+		return function() return sget(false) end
+	end
+	if _class.nonstaticmembers[key] then return function(self) return self[".InstanceValues"][key] end end
+	return _class.methprop.pget[key] or _class.staticprop.pget[key]
+end
+
+function Resolve.iset(_class,key)
+	if _class.methods[key] then
+		return function()
+			print(debug.traceback())
+			error("Cannot overwrite methods: "..key) 
+		end
+	end
+	if _class.staticmembers[key] then
+		local sset=Resolve.sset(_class,key)
+		return function(self,value) sset(value,false) end
+	end
+	local NSM=_class.nonstaticmembers[key]
+	if NSM then
+		return function(self,value)
+			assert(not NSM.constant,"Constants cannot be overwritten")
+			if self[".sealed"] then assert(not NSM.constant,"Read-only members cannot be overwritten") end
+			self[".InstanceValues"][key] = _Scyndi.WANTVALUE(NSM.dtype,value)
+		end
+	end
+	return _class.methprop.pset[key] or _class.staticprop.pset[key]
+end
+
+local function Dispatch(_class)
+	if _class.dispatch then return _class.dispatch end
+	local d = {}
+	for kind,resolve in pairs(Resolve) do
+		d[kind] = setmetatable({},{__index=function(t,key)
+			if type(key)~="string" then return nil end
+			local ukey = key:upper()
+			local a = rawget(t,ukey) or resolve(_class,ukey)
+			if a then
+				t[ukey] = a
+				t[key] = a
+			end
+			return a
+		end})
+	end
+	_class.dispatch = d
+	return d
 end
 
 
-function _Scyndi.STARTCLASS(classname,staticclass,sealable,extends)
+function _Scyndi.STARTCLASS(classname,staticclass,sealable,extends,pooled)
 	local _class = { 
 		name=classname, 
 		staticclass=staticclass, 
@@ -244,7 +428,8 @@ function _Scyndi.STARTCLASS(classname,staticclass,sealable,extends)
 		extends={},
 		extendclass=extends,
 		extended=false,		
-	}		
+	}
+	if pooled then _class.pool = { free={}, created=0, reused=0, released=0 } end		
 	--[[
 	if extends then
 		local uex = extends:upper()
@@ -272,19 +457,25 @@ function _Scyndi.STARTCLASS(classname,staticclass,sealable,extends)
 	local meta={}
 	local metapriv={}
 	function meta.__index(self,key)
+		local a = (_class.dispatch or Dispatch(_class)).sget[key]
+		if a then return a(false) end
 		if type(key)=="number" then return index_static_member(cu,"STATICNUMINDEX")(key) end 
-		if key:upper()==".ISCLASS" then return true end
 		return index_static_member(cu,key)
 	end
 	function meta.__newindex(self,key,value)
+		local a = (_class.dispatch or Dispatch(_class)).sset[key]
+		if a then return a(value,false) end
 		if type(key)=="number" then index_static_member(cu,"STATICNUMNEWINDEX")(key,value) return end
 		return newindex_static_member(cu,key,value)
 	end
 	function metapriv.__index(self,key)
-		if key:upper()==".ISCLASS" then return true end
+		local a = (_class.dispatch or Dispatch(_class)).sget[key]
+		if a then return a(true) end
 		return index_static_member(cu,key,true)
 	end
 	function metapriv.__newindex(self,key,value)
+		local a = (_class.dispatch or Dispatch(_class)).sset[key]
+		if a then return a(value,true) end
 		return newindex_static_member(cu,key,value,true)
 	end
 	function meta.__call(self)
@@ -304,6 +495,7 @@ _Scyndi.CLASSES = setmetatable({},{
 		error("Scyndi.Classes is read-only!") end,
 	__index=function(s,key) 
 		key = key:upper()
+		if not classregister[key] then Resident(key) end
 		assert(classregister[key],"No class named "..key.." found")
 		return classregister[key].pub
 	end	})
@@ -325,6 +517,7 @@ function _Scyndi.ADDPROPERTY(ch,name,static,getset,func)
 	assert(not _class.staticmembers[gs],"Property duplicates static member "..name)
 	assert(not _class.nonstaticmembers[gs],"Property duplicate member "..name)
 	_prop[gs][name]=func
+	Changed(_class)
 	--print("Property "..name.." added to class "..ch) -- debug
 end
 
@@ -348,6 +541,7 @@ function _Scyndi.ADDMBER(ch,dtype,name,static,readonly,constant,value)
 	--for k,v in pairs(nm) do print(k,v) end
 	-- print("Member for ",cu,">",name," Static:",static)
 	if (static) then _class.staticmembers[name]=nm else _class.nonstaticmembers[name]=nm end
+	Changed(_class)
 end
 
 function _Scyndi.ADDABSTRACT(ch,dtype,_name)
@@ -361,6 +555,7 @@ function _Scyndi.ADDABSTRACT(ch,dtype,_name)
 	assert(not _class.nonstaticmembers[name],"Class "..ch.." already has a member named "..name)
 	assert(not _class.abstracts[name],"Class "..ch.." already has an abstract named "..name)
 	_class.abstracts[name]=dtype:upper()
+	Changed(_class)
 end
 
 function _Scyndi.ADDMETHOD(ch,name,IsFinal,func)
@@ -373,11 +568,9 @@ local cu=ch:upper()
 	assert(type(func)=="function","That is not a function, so it cannot be turned into a method")
 	assert( not ( _class.methods[name] and _class.methods[name].IsFinal ), "Final method cannot be overridden")
 	--print("New Method:",name," abstract: "..tostring(_class.abstracts[name]))
-	if (_class.abstracts[name]) then
-		--print("Abstract "..name.." removed from class: "..ch)
-		_class.abstracts[name]=nil 
-	end -- abstract overridden after all!
+	Unabstract(_class,name) -- abstract overridden after all!
 	_class.methods[name] = { IsAbstract=false, IsFinal=IsFinal, Meth = func }
+	Changed(_class)
 end
 
 function _Scyndi.SEAL(ch)
@@ -386,71 +579,178 @@ function _Scyndi.SEAL(ch)
 	assert(classregister[cu].sealable,"Class "..cu.." is NOT sealable")
 	PEC(cu)
 	classregister[cu].sealed=true
+	Flat(classregister[cu])
 	_Scyndi.ADDMBER("..GLOBALS..","TABLE",cu,true,true,true,classregister[cu].pub)
 end
 
-local function InstanceIndex(self,key)
+-- ***** Bulk class registration ***** --
+--[[
+	The translator emits one descriptor per class in stead of an ADDMBER or ADDMETHOD
+	call for every member. The names in there are already in upper case and the
+	translator has already checked the dupes and the types of the literal values,
+	so members marked as checked (7th field) can go in as they are.
+	Members with an order number (8th field) have a function returning their value,
+	as their value depends on other members. These are set after all the other
+	members are in, in the order in which they appeared in the source.
+	Instance members with a 9th field get the value that function returns for
+	every new instance in stead of sharing one. Records need that.
+]]
+local function InstallMember(_class,m,value)
+	local name=m[1]
+	assert(not rawget(_class.staticmembers,name),"Class ".._class.name.." already has a static member named "..name)
+	assert(not rawget(_class.nonstaticmembers,name),"Class ".._class.name.." already has a member named "..name)
+	local nm={ dtype=m[2], readonly=m[4], constant=m[5], value=value, fresh=m[9] }
+	if not m[7] then nm.value=_Scyndi.WANTVALUE(m[2],value or _Scyndi.BASEVALUE(m[2])) end
+	if (m[3]) then _class.staticmembers[name]=nm else _class.nonstaticmembers[name]=nm end
+	Changed(_class)
+end
+
+local function CompleteClass(desc,done,bydesc)
+	if done[desc] then return end
+	done[desc]=true
+	if desc.Extends and bydesc[desc.Extends] then CompleteClass(bydesc[desc.Extends],done,bydesc) end
+	local cu=desc.Name
+	local _class=classregister[cu]
+	PEC(cu)
+	for _,p in ipairs{ {desc.StaticGet,"staticprop","pget"}, {desc.StaticSet,"staticprop","pset"}, {desc.Get,"methprop","pget"}, {desc.Set,"methprop","pset"} } do
+		local gs=p[3]
+		for name,func in pairs(p[1]) do
+			assert(not (rawget(_class.staticprop[gs],name) or rawget(_class.methprop[gs],name)),"There already is a '"..gs.."' function for property "..name)
+			_class[p[2]][gs][name]=func
+		end
+	end
+	for name,func in pairs(desc.Functions) do InstallMember(_class,{name,"DELEGATE",true,true,true,nil,true},func) end
+	for name,dtype in pairs(desc.Abstracts) do
+		assert(not (rawget(_class.staticmembers,name) or rawget(_class.nonstaticmembers,name)),"Class "..cu.." already has a member named "..name)
+		_class.abstracts[name]=dtype
+	end
+	for name,func in pairs(desc.Methods) do
+		assert( not ( _class.methods[name] and _class.methods[name].IsFinal ), "Final method "..cu.."."..name.." cannot be overridden")
+		Unabstract(_class,name)
+		_class.methods[name] = { IsAbstract=false, IsFinal=desc.Finals[name]==true, Meth = func }
+	end
+	Changed(_class)
+	if desc.Seal then
+		assert(_class.sealable,"Class "..cu.." is NOT sealable")
+		_class.sealed=true
+		Flat(_class)
+		InstallMember(classregister["..GLOBALS.."],{cu,"TABLE",true,true,true,nil,true},_class.pub)
+	end
+end
+
+function _Scyndi.REGISTERCLASSES(descs)
+	local bydesc,lazy,done = {},{},{}
+	for _,desc in ipairs(descs) do
+		if desc.Start then _Scyndi.STARTCLASS(desc.Name,desc.Static,desc.Sealable,desc.Extends,desc.Pooled) end
+		assert(classregister[desc.Name],"Class "..desc.Name.." unknown (registration)")
+		assert(not classregister[desc.Name].sealed,"Class "..desc.Name.." is already sealed. No new members allowed!")
+		bydesc[desc.Name]=desc
+	end
+	for _,desc in ipairs(descs) do
+		local _class=classregister[desc.Name]
+		for _,m in ipairs(desc.Members) do
+			if m[8] then lazy[#lazy+1]={_class,m} else InstallMember(_class,m,m[6]) end
+		end
+	end
+	table.sort(lazy,function(a,b) return a[2][8]<b[2][8] end)
+	for _,l in ipairs(lazy) do InstallMember(l[1],l[2],l[2][6]()) end
+	for _,desc in ipairs(descs) do CompleteClass(desc,done,bydesc) end
+end
+
+function InstanceIndex(self,key)
 	--print("Want: ",key,v)
+	local CR = self[".TiedToClass"].CR
+	local a = (CR.dispatch or Dispatch(CR)).iget[key]
+	if a then return a(self) end
 	if type(key)=="number" then
 		return self.NumIndex(key)
 	end
-	key=key:upper()
-	assert(key~="CONSTRUCTOR","Illegal constructor call")
-	assert(key~="DESTRUCTOR","Illegal destructor call")
-	if key==".CLASSINSTANCE" or key==".ISCLASSINSTANCE" then return true end
-	if key==".CLASSNAME" then return self[".TiedToClass"].CL.name end
-	if key==".ISCLASS" then return false end
-	if key==".HASMEMBER" then
-		return function(key)
-			if self[".Methods"][key] then return true end
-			if self[".TiedToClass"].CR.staticmembers[key] then return true end
-			if self[".TiedToClass"].CR.nonstaticmembers[key] then return true end
-			if self[".TiedToClass"].CR.methprop.pget[key] then return true end
-			if self[".TiedToClass"].CR.staticprop.pget[key] then return true end
-			return false
-		end
-	end
-	if self[".Methods"][key] then return function(...) return self[".Methods"][key](self,...) end end
-	local TTC = self[".TiedToClass"]
-	if self[".TiedToClass"].CR.staticmembers[key] then return index_static_member(self[".TiedToClass"].CH,key) end
-	if self[".TiedToClass"].CR.nonstaticmembers[key] then return self[".InstanceValues"][key] end
-	if self[".TiedToClass"].CR.methprop.pget[key] then return TTC.CR.methprop.pget[key](self) end	
-	if self[".TiedToClass"].CR.staticprop.pget[key] then return TTC.CR.staticprop.pget[key](self) end	
 	print(debug.traceback()) -- ?
-	error("R:Class "..TTC.CH.." does not have a member named "..key)
+	error("R:Class "..self[".TiedToClass"].CH.." does not have a member named "..key:upper())
 end
 
-local function InstanceNewIndex(self,key,value)
+function InstanceNewIndex(self,key,value)
 	-- print("InstanceNewIndex",self,key,value) -- ???
 	assert(key,"Nil received for key")
+	local CR = self[".TiedToClass"].CR
+	local a = (CR.dispatch or Dispatch(CR)).iset[key]
+	if a then return a(self,value) end
 	if type(key)=="number" then
 		self.NumNewIndex(key,value)
 		return
 	end
-	key=key:upper()
-	local TTC = self[".TiedToClass"]
-	-- print(TTC.CH,"Mem:"..key,"Static:",TTC.CR.staticmembers[key],"NonStatic:",TTC.CR.nonstaticmembers[key]) -- InstanceNewIndex Debug
-	if self[".Methods"][key] then 
-		print(debug.traceback())
-		error("Cannot overwrite methods: "..key) 
-	end
-	if TTC.CR.staticmembers[key] then newindex_static_member(self[".TiedToClass"].CH,key,value); return; end
-	if TTC.CR.nonstaticmembers[key] then
-		local NSM=TTC.CR.nonstaticmembers[key]
-		assert(not NSM.constant,"Constants cannot be overwritten")
-		if self[".sealed"] then assert(not NSM.constant,"Read-only members cannot be overwritten") end
-		self[".InstanceValues"][key] = _Scyndi.WANTVALUE(NSM.dtype,value)
-		return
+	error("W:Class "..self[".TiedToClass"].CH.." does not have a member named "..key:upper())
+end
+
+-- ***** Pooled classes ***** --
+--[[
+	Instances of a pooled class can be given back with RELEASE, which runs
+	the DESTRUCTOR and puts them on the free list of their class. NEW takes
+	them from there when it can, resets the members to their defaults and
+	runs the CONSTRUCTOR again, so none of the tables of an instance have to
+	be made again. An instance dropped without being released is just
+	collected as usual.
+	Until NEW takes it again, a released instance has a metatable that
+	makes any use of it an error. That only costs something when releasing
+	and reusing, not when accessing members.
+]]
+local function UsedAfterRelease(self) error("This instance of "..self[".TiedToClass"].CH.." has been released, and can't be used anymore") end
+local ReleasedMeta = { __index=UsedAfterRelease, __newindex=UsedAfterRelease }
+
+local function Reuse(_class,...)
+	local pool = _class.pool
+	local Ret = pool.free[#pool.free]
+	pool.free[#pool.free] = nil
+	pool.reused = pool.reused + 1
+	rawset(Ret,".released",nil)
+	local flat = Flat(_class)
+	setmetatable(Ret,flat.meta)
+	local iv = Ret[".InstanceValues"]
+	for FK,FV in pairs(flat.nonstaticmembers) do iv[FK]=FV.fresh and FV.fresh() or FV.value end
+	Ret[".sealed"]=false
+	if (Ret[".Methods"].CONSTRUCTOR) then Ret[".Methods"].CONSTRUCTOR(Ret,...) end
+	Ret[".sealed"]=true
+	return Ret
+end
+
+function _Scyndi.RELEASE(obj)
+	assert(type(obj)=="table" and rawget(obj,".TiedToClass"),"Only class instances can be released")
+	local TTC = obj[".TiedToClass"]
+	local pool = TTC.CR.pool
+	assert(pool,"Class "..TTC.CH.." is not pooled, so its instances cannot be released")
+	assert(not rawget(obj,".released"),"This instance of "..TTC.CH.." has already been released")
+	if (obj[".Methods"].DESTRUCTOR) then obj[".Methods"].DESTRUCTOR(obj) end
+	rawset(obj,".released",true)
+	rawset(obj,".Bound",nil)
+	setmetatable(obj,ReleasedMeta)
+	pool.released = pool.released + 1
+	pool.free[#pool.free+1] = obj
+end
+
+-- Statistics of the pool of a class, or of all pooled classes (by name) when no class is given
+function _Scyndi.POOLSTATS(ch)
+	local function Stats(pool) return { Created=pool.created, Reused=pool.reused, Released=pool.released, Free=#pool.free } end
+	if ch then
+		local cu = ch:upper()
+		assert(classregister[cu],"Class "..ch.." unknown (pool statistics)")
+		assert(classregister[cu].pool,"Class "..ch.." is not pooled")
+		return Stats(classregister[cu].pool)
 	end
-	if TTC.CR.methprop.pset[key] then TTC.CR.methprop.pset[key](self,value) return end
-	if TTC.CR.staticprop.pset[key] then TTC.CR.staticprop.pset[key](self,value) return end
-	error("W:Class "..TTC.CH.." does not have a member named "..key)
+	local ret = {}
+	for cu,_class in pairs(classregister) do
+		if _class.pool then ret[cu] = Stats(_class.pool) end
+	end
+	return ret
 end
 
 function _Scyndi.NEW(ch,...)
 	ch=ch:upper()
 	assert(classregister[ch],"Class "..ch.." unknown (new object)")
 	local _class = classregister[ch]
+	if _class.pool then
+		if #_class.pool.free>0 then return Reuse(_class,...) end
+		_class.pool.created = _class.pool.created + 1
+	end
 	local Ret = {
 		--[".TrueInstance"]={}, 
 		[".InstanceValues"]={},
@@ -458,23 +758,20 @@ function _Scyndi.NEW(ch,...)
 		[".TiedToClass"]={ CL=_Scyndi.CLASS[ch],CR=classregister[ch],CH=ch },
 		[".sealed"] = false
 	}
-	for ab,_ in pairs(_class.abstracts) do
+	local flat = Flat(_class)
+	for ab,_ in pairs(flat.abstracts) do
 		error("Abstract "..ab.." found in class "..ch.."! Not possible to create new instance until all abstracts have been overridden!")
 	end 
-	for MK,MF in pairs(_class.methods) do
+	for MK,MF in pairs(flat.methods) do
 		if MF.IsAbstract then error("Class "..ch.." contains abstracts") end
 		-- for MFK,MFV in pairs(MF) do io.write(type(MFV)," ",MK,".",MFK," -> ",tostring(MFV),"\n") end -- debug
 		Ret[".Methods"][MK] = MF.Meth
 	end
-	for FK,FV in pairs(_class.nonstaticmembers) do
+	for FK,FV in pairs(flat.nonstaticmembers) do
 		-- print("Non-Static",FK,FV) -- debug
-		Ret[".InstanceValues"][FK]=FV.value
+		Ret[".InstanceValues"][FK]=FV.fresh and FV.fresh() or FV.value
 	end
-	setmetatable(Ret,{
-		__index=InstanceIndex,
-		__newindex=InstanceNewIndex,
-		__gc=function(self) if (Ret[".Methods"].DESTRUCTOR) then Ret[".Methods"].DESTRUCTOR(self) end end
-	})
+	setmetatable(Ret,flat.meta)
 	if (Ret[".Methods"].CONSTRUCTOR) then Ret[".Methods"].CONSTRUCTOR(Ret,...) end
 	Ret[".sealed"]=true
 	return Ret
@@ -548,6 +845,9 @@ end)
 
 _Scyndi.ADDMBER("..GLOBALS..","DELEGATE","ERROR",true,true,true,error)
 
+_Scyndi.ADDMBER("..GLOBALS..","DELEGATE","RELEASE",true,true,true,_Scyndi.RELEASE)
+_Scyndi.ADDMBER("..GLOBALS..","DELEGATE","POOLSTATS",true,true,true,_Scyndi.POOLSTATS)
+
 _Scyndi.ADDMBER("..GLOBALS..","DELEGATE","LEFT",true,true,true, function(s, l) 
 			if not assert(type(s)=="string","String exected as first argument for 'left'") then return end
 			l = l or 1
@@ -913,25 +1213,40 @@ _Scyndi.SUB = _Scyndi.SUBSTRACT
 
 
 -- ***** Lua basic modules/libraries/whatever copied into Scyndi groups ***** --
-local function Lua2GlobGroup(original,target)
+--[[
+	The Lua libraries are groups, but their members are only made when
+	first used, as most of them never will be, and a Lua state can be
+	created for every sandboxed script. The name is looked up in lower
+	case first, which is how the libraries have all their names, and
+	otherwise in a table of all names in upper case, only made when
+	that's needed. _G is copied when the group is made, as that one is
+	bound to change, and the group should only have what was there.
+]]
+local LuaTypes = { ["function"]="DELEGATE", number="NUMBER", string="STRING", boolean="BOOLEAN", table="TABLE" }
+local function Lua2GlobGroup(original,target,copy)
 	local pub,prv = _Scyndi.STARTCLASS(target,true,true,nil)
-	for k,v in pairs(original) do
-		if type(v)=="function" then
-			_Scyndi.ADDMBER(target,"DELEGATE",k:upper(),true,true,true,v)
-		elseif type(v)=="userdata" then
-			_Scyndi.ADDMBER(target,"VAR",k:upper(),true,true,true,v)
-		elseif type(v)=="number" then
-			_Scyndi.ADDMBER(target,"NUMBER",k:upper(),true,true,true,v)
-		elseif type(v)=="string" then
-			_Scyndi.ADDMBER(target,"STRING",k:upper(),true,true,true,v)
-		elseif type(v)=="boolean" then
-			_Scyndi.ADDMBER(target,"BOOLEAN",k:upper(),true,true,true,v)
-		elseif type(v)=="table" then
-			_Scyndi.ADDMBER(target,"TABLE",k:upper(),true,true,true,v)
-		else
-			_Scyndi.ADDMBER(target,"VAR",k:upper(),true,true,true,v)
-		end
+	if copy then
+		local c = {}
+		for k,v in pairs(original) do c[k]=v end
+		original = c
 	end
+	local upper
+	setmetatable(classregister[target:upper()].staticmembers,{__index=function(t,key)
+		if type(key)~="string" then return nil end
+		local v = rawget(original,key:lower())
+		if v==nil then
+			if not upper then
+				upper = {}
+				for k in pairs(original) do if type(k)=="string" then upper[k:upper()]=k end end
+			end
+			if upper[key]==nil then return nil end
+			v = rawget(original,upper[key])
+		end
+		if v==nil then return nil end
+		local nm = { dtype=LuaTypes[type(v)] or "VAR", readonly=true, constant=true, value=v }
+		rawset(t,key,nm)
+		return nm
+	end})
 	_Scyndi.SEAL(target)
 end
 
@@ -942,7 +1257,7 @@ Lua2GlobGroup(math,"math")
 Lua2GlobGroup(string,"lstring")
 Lua2GlobGroup(table,"ltable")
 
-Lua2GlobGroup(_G,"PrLua") -- Difference between this and "Lua" is that "Lua" links directly to _G and this one does not and can therefore also not access non-existent variables, nor be used to assign any data to either new or existent members
+Lua2GlobGroup(_G,"PrLua",true) -- Difference between this and "Lua" is that "Lua" links directly to _G and this one does not and can therefore also not access non-existent variables, nor be used to assign any data to either new or existent members
 
 
 
@@ -962,11 +1277,37 @@ function _Scyndi.USE(file)
 	local ufile = file
 	if not UseCaseSensitive then ufile = file:upper() end
 	if FilesUsed[ufile] then return end
-	UseFunction = UseFuncion or DefaultUse
-	UseFunction(file)
+	local chunk = Linked[file:upper()]
+	if chunk == true then
+		-- Already ran (under a differently cased name)
+	elseif Lazy[file:upper()] then
+		return -- Stays a stub until something it defines is accessed
+	elseif chunk then
+		Linked[file:upper()] = true
+		chunk()
+	else
+		UseFunction = UseFuncion or DefaultUse
+		UseFunction(file)
+	end
 	FilesUsed[ufile]=true
 end
 
+function _Scyndi.LINKCHUNK(file,chunk)
+	assert(type(chunk)=="function","Function expected but got "..type(chunk).." for LinkChunk")
+	Linked[file:upper()] = chunk
+end
+
+-- loader must return the chunk of the module. It's only called once something the module defines is accessed.
+function _Scyndi.LINKLAZY(file,loader)
+	assert(type(loader)=="function","Function expected but got "..type(loader).." for LinkLazy")
+	Lazy[file:upper()] = loader
+end
+
+-- Tells which module defines a global or class. Only needed for modules given to LinkLazy.
+function _Scyndi.PROVIDES(identifier,file)
+	Provider[identifier:upper()] = file:upper()
+end
+
 function _Scyndi.SETUSEFUNCTION(f)
 	assert(f==nil or type(f)=="function","Function expected but got "..type(f).." for SetUseFunction")
 	UseFuncion = f
@@ -994,6 +1335,7 @@ end
 local function AllStuff_Index(s,key)
 	key = key:upper()
 	local ret 
+	Resident(key)
 	if classregister[key] then return classregister[key].pub end
 	if classregister["..GLOBALS.."].staticmembers[key] then return _Scyndi.GLOBALS[key] end
 	error("Neither a class nor a global named "..key.." has been found")	
@@ -1001,6 +1343,7 @@ end
 
 local function AllStuff_NewIndex(s,key,value)
 	key = key:upper()
+	Resident(key)
 	assert(not classregister[key],"Classes are read-only!")
 	assert(classregister["..GLOBALS.."].staticmembers[key],"No global named "..key.." found")
 	_Scyndi.GLOBALS[key]=value
@@ -1010,6 +1353,7 @@ _Scyndi.ALLIDENTIFIERS = setmetatable({},{__index=AllStuff_Index,__newindex=AllS
 
 function _Scyndi.HASIDENTIFIER(key)
 	key = key:upper()
+	Resident(key)
 	if classregister[key] then return "Class" end
 	if _Scyndi.GLOBALS[".HASMEMBER"](key) then return "Global" end
 	return nil
@@ -1025,6 +1369,7 @@ end
 -- Please note. Scyndi code itself should not be able to link directly 
 -- to this (although you can ways do Lua.Globals.Scyndi.Debug if you really desire)
 -- The Scyndi compiler will put the calls if you set it to make a debug build
+-- (Line only with LineCalls=TRUE in the [Debug] section of the project. See 'Line maps' below for the way to trace errors back without it)
 
 local _ScyndiDebug = {}
 
@@ -1071,3 +1416,69 @@ _Scyndi.DEBUG = setmetatable({},{
 	end
 		
 })
+
+
+-- ***** Line maps ***** --
+-- Every translation comes with a map telling which Scyndi file and line every Lua line came from (LineMap.bin in the STB, Link/LineMap.bin in a linked bundle).
+-- Once an engine handed that over to Scyndi.LineMap, error messages and tracebacks can be put in Scyndi terms.
+-- That way debug builds don't need Scyndi.Debug.Line calls on every line to tell where something went wrong.
+
+local LineMaps = {} -- Lua source (as debug info calls it) => { files, runs }
+
+function _Scyndi.LINEMAP(data)
+	local pos = 1
+	while pos <= #data do
+		assert(data:sub(pos,pos+3)=="SLMP","Invalid line map")
+		local version,chunk,count
+		version, pos = string.unpack("<I4",data,pos+4)
+		assert(version==1,"Unsupported line map version")
+		chunk, pos = string.unpack("<s4",data,pos)
+		local map = { files={}, lua={}, file={}, line={} }
+		count, pos = string.unpack("<I4",data,pos)
+		for i=1,count do map.files[i], pos = string.unpack("<s4",data,pos) end
+		count, pos = string.unpack("<I4",data,pos)
+		for i=1,count do map.lua[i], map.file[i], map.line[i], pos = string.unpack("<I4I4I4",data,pos) end
+		LineMaps[chunk] = map
+	end
+end
+
+-- Returns the Scyndi file and line, or nil when the source has no map
+function _Scyndi.MAPLINE(source,line)
+	local map = LineMaps[source]
+	if not (map and line and line>0) then return nil end
+	local lo,hi = 1,#map.lua
+	if hi==0 or map.lua[1]>line then return nil end
+	while lo<hi do
+		local mid = (lo+hi+1)//2
+		if map.lua[mid]<=line then lo=mid else hi=mid-1 end
+	end
+	return map.files[map.file[lo]+1], map.line[lo]
+end
+
+function _Scyndi.MAPTRACE(trace)
+	trace = tostring(trace)
+	for source,_ in pairs(LineMaps) do
+		if source:sub(1,1)=="@" then
+			local pattern = source:sub(2):gsub("%p","%%%0")..":(%d+)"
+			local i = 1
+			while true do
+				local s,e,l = trace:find(pattern,i)
+				if not s then break end
+				local f,sl = _Scyndi.MAPLINE(source,tonumber(l))
+				if f then
+					local pos = f..":"..sl
+					trace = trace:sub(1,s-1)..pos..trace:sub(e+1)
+					i = s + #pos
+				else
+					i = e + 1
+				end
+			end
+		end
+	end
+	return trace
+end
+
+-- Can be used as message handler for xpcall
+function _Scyndi.TRACEBACK(msg)
+	return _Scyndi.MAPTRACE(debug.traceback(tostring(msg),2))
+end
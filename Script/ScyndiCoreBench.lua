@@ -0,0 +1,333 @@
+-- License:
+-- 
+-- Scyndi
+-- Core benchmark
+-- 
+-- 
+-- 
+-- 	(c) Jeroen P. Broks, 2026
+-- 
+-- 		This program is free software: you can redistribute it and/or modify
+-- 		it under the terms of the GNU General Public License as published by
+-- 		the Free Software Foundation, either version 3 of the License, or
+-- 		(at your option) any later version.
+-- 
+-- 		This program is distributed in the hope that it will be useful,
+-- 		but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- 		MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- 		GNU General Public License for more details.
+-- 		You should have received a copy of the GNU General Public License
+-- 		along with this program.  If not, see <http://www.gnu.org/licenses/>.
+-- 
+-- 	Please note that some references to data like pictures or audio, do not automatically
+-- 	fall under this licenses. Mostly this is noted in the respective files.
+-- 
+-- Version: 26.10.19
+-- End License
+--[[
+
+	Times the core operations translated scripts hit every frame.
+	Run by "quickscyndi -corebench", which sets ScyndiBench.Now to a 
+	nanosecond clock, but it can also be run with a plain Lua 
+	interpreter (os.clock is used then).
+	
+	For every case the results are ns per operation and bytes
+	allocated per operation. The collector is stopped while a case
+	runs, so collectgarbage("count") tells the allocations.
+
+]]
+
+if not Scyndi then require "ScyndiCore" end
+
+ScyndiBench = ScyndiBench or {}
+local Iterations = ScyndiBench.Iterations or 200000
+local Now = ScyndiBench.Now or function() return math.floor(os.clock()*1000000000) end
+
+-- ***** Test class ***** --
+-- Set up the same way translated code does it
+local BenchGlobals = { Name="..GLOBALS..", Start=false,
+	Members={
+		{"BENCHGLOBAL", "INT", true, false, false, 0, true},
+	},
+	Methods={}, Finals={}, Functions={}, Abstracts={}, Get={}, Set={}, StaticGet={}, StaticSet={} }
+local BenchObject = { Name="BENCHOBJECT", Start=true, Static=false, Sealable=true,
+	Members={
+		{"X", "INT", false, false, false, 0, true},
+		{"NAME", "STRING", false, false, false, "Bench", true},
+		{"COUNTER", "INT", true, false, false, 0, true},
+	},
+	Methods={}, Finals={}, Functions={}, Abstracts={}, Get={}, Set={}, StaticGet={}, StaticSet={} }
+rawset(BenchObject.Get, "DOUBLED", function(self) return self.X * 2 end)
+rawset(BenchObject.Set, "DOUBLED", function(self,_value) self.X = _value // 2 end)
+rawset(BenchObject.Methods, "CONSTRUCTOR", function(self) self.X = 1 end)
+rawset(BenchObject.Methods, "STEP", function(self,a) return self.X + a end)
+Scyndi.RegisterClasses({ BenchGlobals, BenchObject })
+
+-- ***** Cases ***** --
+-- Every case gets the number of iterations and must do its operation that many times
+-- Cases with a scale get the number of iterations divided by that, for operations too heavy to do that often
+local Cases = {}
+local function Case(Name,Func,Scale) Cases[#Cases+1] = { Name=Name, Func=Func, Scale=Scale or 1 } end
+
+Case("Empty loop",function(n) for i=1,n do end end)
+Case("New",function(n) for i=1,n do local o = Scyndi.New("BenchObject") end end)
+do
+	local o = Scyndi.New("BenchObject")
+	Case("Member get",function(n) local r for i=1,n do r = o.X end end)
+	Case("Member set",function(n) for i=1,n do o.X = i end end)
+	Case("Member set string",function(n) for i=1,n do o.Name = "Bench" end end)
+	Case("Method call",function(n) for i=1,n do o.Step(i) end end)
+	Case("Property get",function(n) local r for i=1,n do r = o.Doubled end end)
+	Case("Property set",function(n) for i=1,n do o.Doubled = i end end)
+	Case("Static get (instance)",function(n) local r for i=1,n do r = o.Counter end end)
+	Case("Static get (class)",function(n) local r for i=1,n do r = Scyndi.Class.BenchObject.Counter end end)
+	Case("Static set (class)",function(n) for i=1,n do Scyndi.Class.BenchObject.Counter = i end end)
+end
+Case("Global get",function(n) local r for i=1,n do r = Scyndi.Globals.BenchGlobal end end)
+Case("Global set",function(n) for i=1,n do Scyndi.Globals.BenchGlobal = i end end)
+Case("CreateLocals",function(n) 
+	for i=1,n do 
+		local l = Scyndi.CreateLocals()
+		Scyndi.DeclareLocal(l, "INT", false, "I", 0)
+	end 
+end)
+do
+	local l = Scyndi.CreateLocals()
+	Scyndi.DeclareLocal(l, "INT", false, "I", 0)
+	Case("Local get",function(n) local r for i=1,n do r = l.I end end)
+	Case("Local set",function(n) for i=1,n do l.I = i end end)
+end
+for _,T in ipairs{ {"Int",5}, {"Number",5.5}, {"Byte",300}, {"Boolean",1}, {"String","Hello"}, {"Var",true}, {"Table",{}}, {"Delegate",print} } do
+	local dtype,value = T[1],T[2]
+	Case("WantValue "..dtype,function(n) for i=1,n do Scyndi.WantValue(dtype,value) end end)
+end
+do
+	-- "DDEF Dist2 / RETURN Sq(...) / END" called, and inlined as the translator does now
+	local function Sq(x,y) return x*x+y*y end
+	local function Dist2(...) return Sq(...) end
+	Case("Quick function (call)",function(n) local r for i=1,n do r = Dist2(i,2) end end)
+	Case("Quick function (inlined)",function(n) local r for i=1,n do r = Sq(i,2) end end)
+end
+Case("Add number",function(n) local v = 0 for i=1,n do v = Scyndi.Add(v,2) end end)
+Case("Add string",function(n) for i=1,n do Scyndi.Add("Hello","World") end end)
+Case("Inc",function(n) local v = 0 for i=1,n do v = Scyndi.Inc(v) end end)
+do
+	-- A function with two DEFERs, as a list of closures run at the exit, and inlined at the exit the way the translator does it now
+	local v = 0
+	local function Listed() local d = {} d[#d+1] = function() v = v + 1 end d[#d+1] = function() v = v - 1 end for _,f in ipairs(d) do f() end end
+	local function Inlined() do v = v - 1 end do v = v + 1 end end
+	Case("Defer (closure list)",function(n) for i=1,n do Listed() end end)
+	Case("Defer (inlined)",function(n) for i=1,n do Inlined() end end)
+end
+do
+	-- A function with a static local: checked in the static register on every call, as a chunk local set at load time, and as a chunk local set on the first call
+	local Register = {}
+	local Hoisted = 0
+	local Once = Register
+	local function Registered() if not Register["Static_00000000"] then ScyndiBench_Static_00000000 = 0; Register["Static_00000000"]=true end return ScyndiBench_Static_00000000 end
+	local function Loaded() return Hoisted end
+	local function FirstCall() if Once == Register then Once = 0 end return Once end
+	Case("Static local (register)",function(n) for i=1,n do Registered() end end)
+	Case("Static local (hoisted)",function(n) for i=1,n do Loaded() end end)
+	Case("Static local (first call)",function(n) for i=1,n do FirstCall() end end)
+end
+do
+	local arr = Scyndi.Globals.NewArray(1,2,3,4,5,6,7,8,9,10)
+	-- These cases do ten elements per operation
+	Case("Each (10)",function(n) for i=1,n do for v in Scyndi.Globals.Each(arr) do end end end)
+	Case("IPairs (10)",function(n) for i=1,n do for k,v in Scyndi.Globals.IPairs(arr) do end end end)
+	Case("Len array (10)",function(n) for i=1,n do Scyndi.Globals.Len(arr) end end)
+end
+Case("Len string",function(n) for i=1,n do Scyndi.Globals.Len("Hello World") end end)
+Case("Left",function(n) for i=1,n do Scyndi.Globals.Left("Hello World",5) end end)
+Case("Right",function(n) for i=1,n do Scyndi.Globals.Right("Hello World",5) end end)
+Case("Mid",function(n) for i=1,n do Scyndi.Globals.Mid("Hello World",3,4) end end)
+Case("Upper",function(n) for i=1,n do Scyndi.Globals.Upper("Hello World") end end)
+Case("Trim",function(n) for i=1,n do Scyndi.Globals.Trim("  Hello World  ") end end)
+Case("Prefixed",function(n) for i=1,n do Scyndi.Globals.Prefixed("Hello World","Hello") end end)
+Case("Split",function(n) for i=1,n do Scyndi.Globals.Split("A,B,C,D",",") end end)
+Case("SPrintF",function(n) for i=1,n do Scyndi.Globals.SPrintF("%s=%d","X",i) end end)
+do
+	-- Module initialization: a class with 20 members and 20 methods, registered call by call or with a descriptor
+	local Count = 0
+	local MName,FName = {},{}
+	for i=1,20 do MName[i]="M"..i FName[i]="F"..i end
+	local function Meth(self) return self end
+	Case("Register class (calls)",function(n)
+		for i=1,n do
+			Count = Count + 1
+			local cn = "BENCHREG"..Count
+			Scyndi.StartClass(cn,true,true,nil)
+			for m=1,20 do Scyndi.ADDMBER(cn,"INT",MName[m],false,false,false,m) end
+			for m=1,20 do Scyndi.ADDMETHOD(cn,FName[m],false,Meth) end
+			Scyndi.Seal(cn)
+		end
+	end,100)
+	Case("Register class (descr)",function(n)
+		for i=1,n do
+			Count = Count + 1
+			local D = { Name="BENCHREG"..Count, Start=true, Static=true, Sealable=true, Seal=true, Members={}, Methods={}, Finals={}, Functions={}, Abstracts={}, Get={}, Set={}, StaticGet={}, StaticSet={} }
+			for m=1,20 do D.Members[m] = { MName[m], "INT", false, false, false, m, true } end
+			for m=1,20 do D.Methods[FName[m]] = Meth end
+			Scyndi.RegisterClasses({ D })
+		end
+	end,100)
+	-- Startup of a five level hierarchy, every level adding 20 members and 20 methods (200 in total), and making an instance of the last
+	local function Hierarchy(n)
+		local leaf
+		for i=1,n do
+			Count = Count + 1
+			local descs = {}
+			for l=1,5 do
+				local D = { Name="BENCHREG"..Count.."_"..l, Start=true, Static=true, Sealable=true, Seal=true, Members={}, Methods={}, Finals={}, Functions={}, Abstracts={}, Get={}, Set={}, StaticGet={}, StaticSet={} }
+				if l>1 then D.Extends=descs[l-1].Name end
+				for m=1,20 do D.Members[m] = { MName[m]..l, "INT", false, false, false, m, true } end
+				for m=1,20 do D.Methods[FName[m]..l] = Meth end
+				descs[l]=D
+			end
+			Scyndi.RegisterClasses(descs)
+			leaf = descs[5].Name
+		end
+		return leaf
+	end
+	Case("Hierarchy (5x40)",Hierarchy,1000)
+	local Leaf = Hierarchy(1)
+	Case("New (5 levels)",function(n) for i=1,n do local o = Scyndi.New(Leaf) end end,10)
+	local o = Scyndi.New(Leaf)
+	Case("Get own (5 levels)",function(n) local r for i=1,n do r = o.M15 end end)
+	Case("Get base (5 levels)",function(n) local r for i=1,n do r = o.M11 end end)
+	Case("Call base (5 levels)",function(n) for i=1,n do o.F11() end end)
+end
+
+-- ***** Workloads ***** --
+-- Frame based and with the collector running, so the worst frame is mostly a collector pause.
+-- The allocations per frame are measured in a separate run with the collector stopped.
+local Workloads = {}
+local function Workload(Name,Frame) Workloads[#Workloads+1] = { Name=Name, Frame=Frame } end
+do
+	-- Bullet hell: every frame 200 bullets are fired, and every bullet lives for 30 frames
+	local function Bullet(Name,Pooled)
+		local D = { Name=Name, Start=true, Static=true, Sealable=true, Seal=true, Pooled=Pooled,
+			Members={
+				{"X", "NUMBER", false, false, false, 0, true},
+				{"Y", "NUMBER", false, false, false, 0, true},
+				{"DX", "NUMBER", false, false, false, 0, true},
+				{"DY", "NUMBER", false, false, false, 0, true},
+				{"AGE", "INT", false, false, false, 0, true},
+			},
+			Methods={}, Finals={}, Functions={}, Abstracts={}, Get={}, Set={}, StaticGet={}, StaticSet={} }
+		rawset(D.Methods, "CONSTRUCTOR", function(self,dx,dy) self.DX = dx self.DY = dy end)
+		rawset(D.Methods, "STEP", function(self) self.X = self.X + self.DX self.Y = self.Y + self.DY self.AGE = self.AGE + 1 return self.AGE<30 end)
+		Scyndi.RegisterClasses({ D })
+	end
+	Bullet("BENCHBULLET",false)
+	Bullet("BENCHPOOLEDBULLET",true)
+	local function BulletHell(Class,Release)
+		local Live = {}
+		return function()
+			for i=1,200 do Live[#Live+1] = Scyndi.New(Class,math.cos(i),math.sin(i)) end
+			local j = 0
+			for i=1,#Live do
+				local b = Live[i]
+				Live[i] = nil
+				if b.Step() then j = j + 1 Live[j] = b elseif Release then Scyndi.Release(b) end
+			end
+		end
+	end
+	Workload("Bullets",BulletHell("BENCHBULLET",false))
+	Workload("Bullets (pooled)",BulletHell("BENCHPOOLEDBULLET",true))
+	-- The same bullets as a RECORD. This is what the translator makes of "NEW Bullet(DX,DY)" and the field access on it.
+	local function StepRecord(b) b.X = b.X + b.DX b.Y = b.Y + b.DY b.AGE = b.AGE + 1 return b.AGE<30 end
+	local Live = {}
+	Workload("Bullets (record)",function()
+		for i=1,200 do Live[#Live+1] = { DX=math.cos(i), DY=math.sin(i), X=0, Y=0, AGE=0 } end
+		local j = 0
+		for i=1,#Live do
+			local b = Live[i]
+			Live[i] = nil
+			if StepRecord(b) then j = j + 1 Live[j] = b end
+		end
+	end)
+end
+do
+	-- Every frame 1000 instances are made and dropped again, so the collector has 100k of them over 100 frames. Only the second class has a DESTRUCTOR.
+	local Dropped = 0
+	local function Particle(Name,Destructor)
+		local D = { Name=Name, Start=true, Static=true, Sealable=true, Seal=true,
+			Members={
+				{"X", "NUMBER", false, false, false, 0, true},
+				{"Y", "NUMBER", false, false, false, 0, true},
+			},
+			Methods={}, Finals={}, Functions={}, Abstracts={}, Get={}, Set={}, StaticGet={}, StaticSet={} }
+		if Destructor then rawset(D.Methods, "DESTRUCTOR", function(self) Dropped = Dropped + 1 end) end
+		Scyndi.RegisterClasses({ D })
+	end
+	Particle("BENCHPARTICLE",false)
+	Particle("BENCHDESTRUCTPARTICLE",true)
+	local function ShortLived(Class) return function() for i=1,1000 do local p = Scyndi.New(Class) end end end
+	Workload("Short-lived",ShortLived("BENCHPARTICLE"))
+	Workload("Short-lived (destructor)",ShortLived("BENCHDESTRUCTPARTICLE"))
+end
+
+-- ***** Run ***** --
+local function Run(C)
+	local n = math.max(Iterations // C.Scale,1)
+	C.Func(math.max(n // 10,1)) -- Warm up
+	collectgarbage("collect")
+	collectgarbage("stop")
+	local Mem = collectgarbage("count")
+	local Start = Now()
+	C.Func(n)
+	local Took = Now() - Start
+	local Alloc = (collectgarbage("count") - Mem) * 1024
+	collectgarbage("restart")
+	return { Name=C.Name, NsPerOp=Took/n, BytesPerOp=Alloc/n }
+end
+
+local function RunWorkload(W)
+	local Frames = math.max(Iterations // 1000,60)
+	for i=1,30 do W.Frame() end -- Warm up, and up to the steady state
+	collectgarbage("collect")
+	collectgarbage("stop")
+	local Mem = collectgarbage("count")
+	for i=1,Frames do W.Frame() end
+	local Alloc = (collectgarbage("count") - Mem) * 1024
+	collectgarbage("restart")
+	collectgarbage("collect")
+	local Total,Worst = 0,0
+	for i=1,Frames do
+		local Start = Now()
+		W.Frame()
+		local Took = Now() - Start
+		Total = Total + Took
+		if Took>Worst then Worst = Took end
+	end
+	return { Name=W.Name, Frames=Frames, NsPerFrame=Total/Frames, WorstNs=Worst, BytesPerFrame=Alloc/Frames }
+end
+
+local function JSONString(s) return '"'..s:gsub('[%c"\\]',function(c) return string.format("\\u%04x",c:byte()) end)..'"' end
+
+local Results = {}
+for _,C in ipairs(Cases) do
+	local R = Run(C)
+	Results[#Results+1] = R
+	print(string.format("%-25s %12.1f ns/op %10.1f bytes/op",R.Name,R.NsPerOp,R.BytesPerOp))
+end
+local WResults = {}
+for _,W in ipairs(Workloads) do
+	local R = RunWorkload(W)
+	WResults[#WResults+1] = R
+	print(string.format("%-25s %12.1f ns/frame %12.1f worst %10.1f bytes/frame",R.Name,R.NsPerFrame,R.WorstNs,R.BytesPerFrame))
+end
+
+local J = { "{\n\t\"lua\": "..JSONString(_VERSION)..",\n\t\"iterations\": "..Iterations..",\n\t\"cases\": [\n" }
+for i,R in ipairs(Results) do
+	J[#J+1] = string.format("\t\t{ \"name\": %s, \"ns_per_op\": %.3f, \"bytes_per_op\": %.3f }%s\n",JSONString(R.Name),R.NsPerOp,R.BytesPerOp,i<#Results and "," or "")
+end
+J[#J+1] = "\t],\n\t\"workloads\": [\n"
+for i,R in ipairs(WResults) do
+	J[#J+1] = string.format("\t\t{ \"name\": %s, \"frames\": %d, \"ns_per_frame\": %.3f, \"worst_ns\": %.3f, \"bytes_per_frame\": %.3f }%s\n",JSONString(R.Name),R.Frames,R.NsPerFrame,R.WorstNs,R.BytesPerFrame,i<#WResults and "," or "")
+end
+J[#J+1] = "\t]\n}\n"
+ScyndiBench.JSON = table.concat(J)
+return ScyndiBench.JSON
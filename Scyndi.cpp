@@ -36,6 +36,9 @@
 #include "ScyndiVersion.hpp"
 #include "Compiler/Config.hpp"
 #include "Compiler/ScyndiProject.hpp"
+#include "Compiler/Watch.hpp"
+#include "Compiler/LZ4Block.hpp"
+#include "Compiler/Timings.hpp"
 
 using namespace Scyndi;
 using namespace Slyvina;
@@ -45,6 +48,7 @@ using namespace Slyvina::JCR6;
 int main(int nargs, char** args) {
 	using namespace Scyndi;
 	init_zlib();
+	init_lz4block();
 	JCR6_InitRealDir();
 	QCol->LGreen("Scyndi Compiler\n");
 	QCol->Doing("Version", QVersion.Version(true));
@@ -60,6 +64,10 @@ int main(int nargs, char** args) {
 	AddFlag(cargs, "sf", false); // if true project, if false single file
 	AddFlag(cargs, "dbg", false);
 	AddFlag(cargs, "force", false);
+	AddFlag(cargs, "deterministic", false);
+	AddFlag(cargs, "watch", false);
+	AddFlag(cargs, "release", false);
+	AddFlag(cargs, "timings", false);
 	RegArgs(cargs, nargs, args);
 	if (!NumFiles()) {
 		QCol->White("Usage: ");
@@ -70,18 +78,29 @@ int main(int nargs, char** args) {
 		QCol->LCyan("\t-sf     "); QCol->LGreen("Single files (in stead of project\n");
 		QCol->LCyan("\t-dbg    "); QCol->LGreen("Make debug builds\n");
 		QCol->LCyan("\t-force    "); QCol->LGreen("Force a compilation\n");
+		QCol->LCyan("\t-deterministic    "); QCol->LGreen("Reproducible output (no dates and times in the translations)\n");
+		QCol->LCyan("\t-watch    "); QCol->LGreen("Keep running and rebuild whatever changes (first project only)\n");
+		QCol->LCyan("\t-release    "); QCol->LGreen("Release profile (no Lua source in the bundles, debug info goes to .Symbols.STB files)\n");
+		QCol->LCyan("\t-timings    "); QCol->LGreen("Time every compiler phase per file and write a JSON report next to the (first) project\n");
+		QCol->LCyan("\t            "); QCol->LGreen("Allocations are only counted by builds made with \"scons countallocs=1\"\n");
 		QCol->Reset();
 		std::cout << "\n\n\n";
 		return 1;
 	} else if (WantProject()) {
 		uint64 NietGoed{ 0 };
 		auto F{ Files() };
+		if (WantWatch() && NumFiles() > 1) QCol->Warn("Only the first project will be watched");
+		InitTimings(WantTimings());
+		std::string TimingsFile{ "" };
 		for (size_t i = 0; i < NumFiles(); i++) {
 			auto Prj = (*F)[i];
 			if ((!Suffixed(Lower(Prj), ".scyndiproject")) && (!Suffixed(Lower(Prj), ".ini"))) Prj += ".ScyndiProject";
 			QCol->Doing(TrSPrintF("Project %d/%d", i+1, NumFiles()), Prj);
+			if (WantWatch()) return (int)WatchProject(Prj, WantForce(), WantDebug());
+			if (!TimingsFile.size()) TimingsFile = StripExt(Prj) + ".Timings.json";
 			NietGoed+=ProcessProject(Prj, WantForce(), WantDebug());
 		}
+		TimingsReport(TimingsFile);
 		return NietGoed;
 	}
 	return 0;
@@ -0,0 +1,86 @@
+# License:
+# 
+# Scyndi
+# Compiler benchmark driver
+# 
+# 
+# 
+# 	(c) Jeroen P. Broks, 2026
+# 
+# 		This program is free software: you can redistribute it and/or modify
+# 		it under the terms of the GNU General Public License as published by
+# 		the Free Software Foundation, either version 3 of the License, or
+# 		(at your option) any later version.
+# 
+# 		This program is distributed in the hope that it will be useful,
+# 		but WITHOUT ANY WARRANTY; without even the implied warranty of
+# 		MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# 		GNU General Public License for more details.
+# 		You should have received a copy of the GNU General Public License
+# 		along with this program.  If not, see <http://www.gnu.org/licenses/>.
+# 
+# 	Please note that some references to data like pictures or audio, do not automatically
+# 	fall under this licenses. Mostly this is noted in the respective files.
+# 
+# Version: 26.10.19
+# End License
+
+# Runs the compiler on a generated corpus (see ScyndiCorpus.py) in three ways:
+#  full    - everything rebuilt (-force)
+#  noop    - nothing changed, so the up to date checks are all that is measured
+#  touch   - one low level module changed, so it and everything depending on it must be rebuilt
+# Usage: python3 ScyndiBench.py <scyndi executable> <corpus dir> [runs=3] [json=<file>] [timings=1]
+
+import os
+import sys
+import json
+import time
+import subprocess
+
+def Lines(corpus):
+    ret=0
+    for root,dirs,files in os.walk(os.path.join(corpus,"Src")):
+        for f in files:
+            with open(os.path.join(root,f)) as h: ret+=sum(1 for _ in h)
+    return ret
+
+def Build(exe,project,flags):
+    start=time.perf_counter()
+    r=subprocess.run([exe]+flags+[project],stdout=subprocess.DEVNULL,stderr=subprocess.PIPE,text=True)
+    took=time.perf_counter()-start
+    if r.returncode: sys.exit("Build failed (%d)\n%s"%(r.returncode,r.stderr))
+    return took
+
+def Touch(corpus,run):
+    # Changing the content matters, not the time stamp, as the up to date check works on checksums
+    f=os.path.join(corpus,"Src","Lib0000.Scyndi")
+    with open(f,"a") as h: h.write("// Touched by ScyndiBench.py (run %d)\n"%run)
+
+def Bench(exe,corpus,runs=3,timings=False):
+    project=os.path.join(corpus,"Corpus.ScyndiProject")
+    lines=Lines(corpus)
+    extra=["-timings"] if timings else []
+    Result={ "lines":lines, "runs":runs }
+    for mode in ("full","noop","touch"):
+        times=[]
+        for run in range(runs):
+            if mode=="full": times.append(Build(exe,project,["-force"]+extra))
+            elif mode=="noop": times.append(Build(exe,project,extra))
+            else:
+                Touch(corpus,run)
+                times.append(Build(exe,project,extra))
+        best=min(times)
+        Result[mode]={ "best":best, "mean":sum(times)/len(times), "lines_per_sec":lines/best if best else 0 }
+        print("\x1b[93m%-6s\x1b[96m%8.3fs\x1b[93m best, \x1b[96m%8.3fs\x1b[93m mean, \x1b[96m%12.0f\x1b[93m lines/sec\x1b[0m"%(mode,best,Result[mode]["mean"],Result[mode]["lines_per_sec"]))
+    return Result
+
+if __name__=="__main__":
+    if len(sys.argv)<3: sys.exit("Usage: ScyndiBench.py <scyndi executable> <corpus dir> [runs=3] [json=<file>] [timings=1]")
+    cfg={ "runs":"3", "json":"", "timings":"0" }
+    for a in sys.argv[3:]:
+        k,_,v=a.partition("=")
+        if k not in cfg: sys.exit("Unknown setting: "+k)
+        cfg[k]=v
+    R=Bench(os.path.abspath(sys.argv[1]),sys.argv[2],int(cfg["runs"]),cfg["timings"]=="1")
+    if cfg["json"]:
+        with open(cfg["json"],"w") as h: json.dump(R,h,indent=1)
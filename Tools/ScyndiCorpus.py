@@ -0,0 +1,191 @@
+# License:
+# 
+# Scyndi
+# Benchmark corpus generator
+# 
+# 
+# 
+# 	(c) Jeroen P. Broks, 2026
+# 
+# 		This program is free software: you can redistribute it and/or modify
+# 		it under the terms of the GNU General Public License as published by
+# 		the Free Software Foundation, either version 3 of the License, or
+# 		(at your option) any later version.
+# 
+# 		This program is distributed in the hope that it will be useful,
+# 		but WITHOUT ANY WARRANTY; without even the implied warranty of
+# 		MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# 		GNU General Public License for more details.
+# 		You should have received a copy of the GNU General Public License
+# 		along with this program.  If not, see <http://www.gnu.org/licenses/>.
+# 
+# 	Please note that some references to data like pictures or audio, do not automatically
+# 	fall under this licenses. Mostly this is noted in the respective files.
+# 
+# Version: 26.10.19
+# End License
+
+# Generates a synthetic Scyndi project for measuring the compiler at scale.
+# Usage: python3 ScyndiCorpus.py <output dir> [scripts=200] [depth=6] [classes=2] [functions=6] [switches=2] [cases=12] [seed=1]
+#
+# Every library module #USEs one or two modules one level below it, so the #USE chains are 'depth' deep.
+# Each module has global functions, classes with properties, switch heavy state machines, macros and a shared include.
+# The main script #USEs the top level modules and calls into them from its Init block.
+
+import os
+import sys
+import random
+import platform
+
+Defaults = { "scripts":200, "depth":6, "classes":2, "functions":6, "switches":2, "cases":12, "seed":1, "includes":8 }
+
+def PlatformName():
+    # Must match what Slyvina::Platform() returns, as the project file has its directories per platform
+    return { "Windows":"Windows", "Darwin":"Mac" }.get(platform.system(),platform.system())
+
+def ModName(i): return "Lib%04d"%i
+
+def Header(kind,i):
+    return "// Generated by ScyndiCorpus.py. Any change will be overwritten.\n\n%s\n\n"%kind
+
+def Include(i,cfg):
+    r=random.Random(cfg["seed"]*7919+i)
+    L=["// Generated by ScyndiCorpus.py. Included by several modules.\n"]
+    L.append("Int Shared%04d_Mix(Int a, Int b)"%i)
+    L.append("\tInt r = a * %d + b"%r.randint(2,9))
+    L.append("\tif r > %d"%r.randint(100,1000))
+    L.append("\t\tr = r - %d"%r.randint(10,90))
+    L.append("\tend")
+    L.append("\treturn r")
+    L.append("end\n")
+    return "\n".join(L)+"\n"
+
+def Module(i,deps,cfg):
+    r=random.Random(cfg["seed"]*104729+i)
+    M=ModName(i)
+    L=[Header("Module",i)]
+    for d in deps: L.append('#USE "Script/%s"'%ModName(d))
+    L.append('#INCLUDE "Script/Inc/Shared%04d.sci"'%(i%cfg["includes"]))
+    L.append("#macro %s_SCALE %d"%(M.upper(),r.randint(2,20)))
+    L.append("#macro %s_LIMIT %d\n"%(M.upper(),r.randint(50,5000)))
+    # Classes with properties
+    for c in range(cfg["classes"]):
+        C="%s_Class%d"%(M,c)
+        L.append("Class %s"%C)
+        L.append("\tInt Value = %d"%r.randint(0,100))
+        L.append("\tInt Steps = 0")
+        L.append("\tString Name = \"%s\"\n"%C)
+        L.append("\tGet Int Doubled")
+        L.append("\t\treturn Value * 2")
+        L.append("\tend\n")
+        L.append("\tSet Int Doubled")
+        L.append("\t\tValue = Value + 1")
+        L.append("\tend\n")
+        L.append("\tInt Twice(Int n)")
+        L.append("\t\treturn n * 2 + %s_SCALE"%M.upper())
+        L.append("\tend")
+        L.append("End\n")
+    # Global functions, each calling into the dependencies
+    for f in range(cfg["functions"]):
+        L.append("Global Int %s_Func%d(Int a)"%(M,f))
+        L.append("\tInt r = Shared%04d_Mix(a, %d)"%(i%cfg["includes"],f))
+        for d in deps: L.append("\tr = r + %s_Func%d(a - 1)"%(ModName(d),r.randrange(cfg["functions"])) if f==0 else "\tr = r + %s_Machine%d(%d, a)"%(ModName(d),r.randrange(cfg["switches"]),r.randrange(cfg["cases"])))
+        L.append("\tif r > %s_LIMIT"%M.upper())
+        L.append("\t\tr = r - %s_LIMIT"%M.upper())
+        L.append("\telif r < 0")
+        L.append("\t\tr = 0")
+        L.append("\tend")
+        L.append("\treturn r")
+        L.append("end\n")
+    # State machines
+    for s in range(cfg["switches"]):
+        L.append("Global Int %s_Machine%d(Int state, Int input)"%(M,s))
+        L.append("\tInt ret = 0")
+        L.append("\tswitch state")
+        for c in range(cfg["cases"]):
+            L.append("\t\tcase %d"%c)
+            op=r.choice(["+","-","*"])
+            L.append("\t\t\tret = input %s %d"%(op,r.randint(1,9)))
+            if r.random()<.2: L.append("\t\t\tfallthrough")
+        L.append("\t\tdefault")
+        L.append("\t\t\tret = -1")
+        L.append("\tend")
+        L.append("\treturn ret")
+        L.append("end\n")
+    return "\n".join(L)+"\n"
+
+def Main(tops,cfg):
+    L=[Header("Script",0)]
+    for t in tops: L.append('#USE "Script/%s"'%ModName(t))
+    L.append("\nInit")
+    L.append("\tInt total = 0")
+    for t in tops:
+        L.append("\ttotal = total + %s_Func0(%d)"%(ModName(t),t%10))
+        if cfg["classes"]:
+            L.append("\tVar o%d = new %s_Class0()"%(t,ModName(t)))
+            L.append("\ttotal = total + o%d.Doubled"%t)
+    L.append("\tprint(\"Corpus total\", total)")
+    L.append("End\n")
+    return "\n".join(L)+"\n"
+
+def Project(out):
+    P=PlatformName()
+    return """[AA_META]
+01_Title=Scyndi benchmark corpus
+02_CreatedBy=ScyndiCorpus.py
+03_Copyright=Generated
+04_License=Public domain
+
+[Package]
+Storage=zlib
+MinGain=10
+
+[DIRECTORY::%s]
+*list:SOURCEFILES
+	%s
+*end
+*list:Libraries
+*end
+"""%(P,os.path.join(out,"Src"))
+
+def Generate(out,cfg):
+    random.seed(cfg["seed"])
+    n=max(2,cfg["scripts"])
+    libs=n-1
+    depth=max(1,min(cfg["depth"],libs))
+    Level=[ i*depth//libs for i in range(libs) ]
+    ByLevel={}
+    for i,l in enumerate(Level): ByLevel.setdefault(l,[]).append(i)
+    os.makedirs(os.path.join(out,"Src","Inc"),exist_ok=True)
+    Lines=0
+    def Write(name,content):
+        nonlocal Lines
+        Lines+=content.count("\n")
+        with open(os.path.join(out,"Src",name),"w") as f: f.write(content)
+    for i in range(cfg["includes"]): Write(os.path.join("Inc","Shared%04d.sci"%i),Include(i,cfg))
+    for i in range(libs):
+        lv=Level[i]
+        deps=[]
+        if lv>0:
+            below=ByLevel[lv-1]
+            deps=sorted(set(random.sample(below,min(len(below),random.randint(1,2)))))
+        Write(ModName(i)+".Scyndi",Module(i,deps,cfg))
+    Write("Main.Scyndi",Main(ByLevel[depth-1],cfg))
+    prj=os.path.join(out,"Corpus.ScyndiProject")
+    with open(prj,"w") as f: f.write(Project(os.path.abspath(out)))
+    print("\x1b[93mCorpus: \x1b[96m%s\x1b[0m"%prj)
+    print("\x1b[93mScripts: \x1b[96m%d (%d levels)\x1b[0m"%(n,depth))
+    print("\x1b[93mLines: \x1b[96m%d\x1b[0m"%Lines)
+    return prj,Lines
+
+def Config(args):
+    cfg=dict(Defaults)
+    for a in args:
+        k,_,v=a.partition("=")
+        if k not in cfg: sys.exit("Unknown setting: "+k)
+        cfg[k]=int(v)
+    return cfg
+
+if __name__=="__main__":
+    if len(sys.argv)<2: sys.exit(__doc__ or "Usage: ScyndiCorpus.py <output dir> [setting=value...]")
+    Generate(sys.argv[1],Config(sys.argv[2:]))